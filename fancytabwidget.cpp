@@ -4,22 +4,32 @@
 #include "fancytabwidget.h"
 
 #include <QCommonStyle>
+#include <QCursor>
 #include <QDebug>
 #include <QFont>
+#include <QFrame>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
 #include <QMouseEvent>
 #include <QPainter>
-#include <QPixmapCache>
+#include <QScreen>
 #include <QStackedLayout>
 #include <QStatusBar>
 #include <QStyleFactory>
 #include <QStyleOption>
 #include <QToolTip>
 #include <QVBoxLayout>
+#include <QVarLengthArray>
 
 #include "qapplication.h"
 #include "qmenu.h"
 
-static const int kMenuButtonWidth = 16;
+static const int kMenuButtonWidth         = 16;
+static const int kMinimumMeasuredTabWidth = 48;
+static const int kHeaderTextIndent        = 16;  // past the collapse arrow
+static const int kHeaderTextMargin        = 4;
 
 namespace Core {
 namespace Constants {
@@ -38,11 +48,130 @@ QPixmap setPixmapColor(QPixmap p, QColor color)
     return pixmap;
 }
 
+static QList<qreal> screenDevicePixelRatios(const QScreen* excluded = nullptr)
+{
+    QList<qreal> ratios;
+    const QList<QScreen*> screens = QGuiApplication::screens();
+    for (const QScreen* screen : screens)
+    {
+        if (screen != excluded && !ratios.contains(screen->devicePixelRatio()))
+        {
+            ratios.append(screen->devicePixelRatio());
+        }
+    }
+    return ratios;
+}
+
+FancyRenderCache::FancyRenderCache()
+    : m_pixmaps(8 * 1024 * 1024)
+{
+    // artwork for a ratio no remaining screen uses would never be hit again
+    m_screenRemovedConnection = QObject::connect(qGuiApp,
+                                                 &QGuiApplication::screenRemoved,
+                                                 [ this ](QScreen* screen)
+                                                 { retainDevicePixelRatios(screenDevicePixelRatios(screen)); });
+}
+
+FancyRenderCache::~FancyRenderCache()
+{
+    QObject::disconnect(m_screenRemovedConnection);
+}
+
+std::shared_ptr<FancyRenderCache> FancyRenderCache::instance()
+{
+    static std::weak_ptr<FancyRenderCache> shared;
+    std::shared_ptr<FancyRenderCache> cache = shared.lock();
+    if (!cache)
+    {
+        cache  = std::make_shared<FancyRenderCache>();
+        shared = cache;
+    }
+    return cache;
+}
+
+QPixmap FancyRenderCache::find(const Key& key)
+{
+    if (const QPixmap* pixmap = m_pixmaps.object(key))
+    {
+        ++m_hits;
+        return *pixmap;
+    }
+    ++m_misses;
+    return {};
+}
+
+void FancyRenderCache::insert(const Key& key, const QPixmap& pixmap)
+{
+    if (pixmap.isNull())
+    {
+        return;
+    }
+    const qsizetype cost = qsizetype(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    m_pixmaps.insert(key, new QPixmap(pixmap), cost);
+}
+
+void FancyRenderCache::clear()
+{
+    m_pixmaps.clear();
+}
+
+void FancyRenderCache::retainDevicePixelRatios(const QList<qreal>& ratios)
+{
+    const QList<Key> keys = m_pixmaps.keys();
+    for (const Key& key : keys)
+    {
+        if (!ratios.contains(key.devicePixelRatio))
+        {
+            m_pixmaps.remove(key);
+        }
+    }
+}
+
+FancyRenderCache::Statistics FancyRenderCache::statistics() const
+{
+    return { m_hits, m_misses, m_pixmaps.count(), m_pixmaps.totalCost(), m_pixmaps.maxCost() };
+}
+
+size_t qHash(const FancyRenderCache::Key& key, size_t seed)
+{
+    return qHashMulti(seed,
+                      key.source,
+                      key.tint,
+                      key.size.width(),
+                      key.size.height(),
+                      key.devicePixelRatio,
+                      key.variant);
+}
+
+static QPixmap tintedIconPixmap(FancyRenderCache* cache,
+                                const QIcon& icon,
+                                const QSize& size,
+                                qreal devicePixelRatio,
+                                QIcon::Mode mode,
+                                QIcon::State state,
+                                const QColor& color)
+{
+    if (icon.isNull())
+    {
+        return {};
+    }
+
+    const FancyRenderCache::Key key { icon.cacheKey(), color.rgba(), size, devicePixelRatio, mode << 1 | state };
+    QPixmap pixmap = cache->find(key);
+    if (pixmap.isNull())
+    {
+        pixmap = setPixmapColor(icon.pixmap(size, devicePixelRatio, mode, state), color);
+        cache->insert(key, pixmap);
+    }
+    return pixmap;
+}
+
 void drawArrow(QStyle::PrimitiveElement element,
                QPainter* painter,
                const QStyleOption* option,
                const QColor& disableColor,
-               const QColor& baseColor)
+               const QColor& baseColor,
+               FancyRenderCache* cache)
 {
     if (option->rect.width() <= 1 || option->rect.height() <= 1)
     {
@@ -53,15 +182,13 @@ void drawArrow(QStyle::PrimitiveElement element,
     const bool enabled           = option->state & QStyle::State_Enabled;
     QRect r                      = option->rect;
     int size                     = qMin(r.height(), r.width());
-    QPixmap pixmap;
-    const QString pixmapName = QString::asprintf("StyleHelper::drawArrow-%d-%d-%d-%f-d%-d%",
-                                                 element,
-                                                 size,
-                                                 enabled,
-                                                 devicePixelRatio,
-                                                 baseColor.rgb(),
-                                                 disableColor.rgb());
-    if (!QPixmapCache::find(pixmapName, &pixmap))
+    const FancyRenderCache::Key key { 0,
+                                      enabled ? baseColor.rgba() : disableColor.rgba(),
+                                      QSize(size, size),
+                                      devicePixelRatio,
+                                      element };
+    QPixmap pixmap = cache->find(key);
+    if (pixmap.isNull())
     {
         QImage image(size * devicePixelRatio, size * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
         image.fill(Qt::transparent);
@@ -102,16 +229,218 @@ void drawArrow(QStyle::PrimitiveElement element,
         painter.end();
         pixmap = QPixmap::fromImage(image);
         pixmap.setDevicePixelRatio(devicePixelRatio);
-        QPixmapCache::insert(pixmapName, pixmap);
+        cache->insert(key, pixmap);
     }
     int xOffset = r.x() + (r.width() - size) / 2;
     int yOffset = r.y() + (r.height() - size) / 2;
     painter->drawPixmap(xOffset, yOffset, pixmap);
 }
 
+static quint64 trigramKey(const QChar* chars)
+{
+    return quint64(chars[ 0 ].unicode()) << 32 | quint64(chars[ 1 ].unicode()) << 16 | chars[ 2 ].unicode();
+}
+
+// word prefixes live in their own key space, above any trigram
+static quint64 prefixKey(QStringView prefix)
+{
+    quint64 key = quint64(1) << 63 | quint64(prefix.size()) << 48;
+    for (qsizetype i = 0; i < qMin<qsizetype>(prefix.size(), 2); ++i)
+    {
+        key |= quint64(prefix.at(i).unicode()) << (16 * (1 - i));
+    }
+    return key;
+}
+
+static QList<quint64> trigramKeys(const QString& text)
+{
+    QList<quint64> keys;
+    for (qsizetype i = 0; i + 2 < text.size(); ++i)
+    {
+        keys.append(trigramKey(text.constData() + i));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+static QList<quint64> indexKeys(const QString& label)
+{
+    QList<quint64> keys = trigramKeys(label);
+    for (qsizetype i = 0; i < label.size(); ++i)
+    {
+        const bool wordStart = i == 0 || !label.at(i - 1).isLetterOrNumber();
+        if (wordStart && label.at(i).isLetterOrNumber())
+        {
+            keys.append(prefixKey(QStringView(label).mid(i, 1)));
+            if (i + 1 < label.size())
+            {
+                keys.append(prefixKey(QStringView(label).mid(i, 2)));
+            }
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+// Prefix beats word start beats substring beats subsequence; shorter labels
+// and earlier matches rank higher. Labels only sharing some trigrams with
+// the query (typos) rank last. Returns 0 for no match.
+static int matchScore(const QString& label, const QString& query, int trigramHits)
+{
+    const int length = int(label.size());
+    const int at     = int(label.indexOf(query));
+    if (at == 0)
+    {
+        return 4000 - length;
+    }
+    if (at > 0)
+    {
+        return (label.at(at - 1).isLetterOrNumber() ? 2000 : 3000) - at - length;
+    }
+
+    int score      = 0;
+    int run        = 0;
+    qsizetype from = 0;
+    for (const QChar c : query)
+    {
+        const qsizetype found = label.indexOf(c, from);
+        if (found < 0)
+        {
+            return qMax(0, trigramHits * 10);
+        }
+        run                  = found == from ? run + 1 : 0;
+        const bool wordStart = found == 0 || !label.at(found - 1).isLetterOrNumber();
+        score += 1 + run * 2 + (wordStart ? 5 : 0);
+        from = found + 1;
+    }
+    return qBound(1, 1000 + score - length, 1999);
+}
+
+void FancyTabIndex::insert(const FancyTab* tab, const QString& label)
+{
+    const QString folded = label.toCaseFolded();
+    m_labels.insert(tab, folded);
+    for (const quint64 key : indexKeys(folded))
+    {
+        m_postings[ key ].insert(tab);
+    }
+}
+
+void FancyTabIndex::remove(const FancyTab* tab)
+{
+    const auto label = m_labels.constFind(tab);
+    if (label == m_labels.cend())
+    {
+        return;
+    }
+    for (const quint64 key : indexKeys(label.value()))
+    {
+        const auto posting = m_postings.find(key);
+        if (posting != m_postings.end())
+        {
+            posting->remove(tab);
+            if (posting->isEmpty())
+            {
+                m_postings.erase(posting);
+            }
+        }
+    }
+    m_labels.erase(label);
+}
+
+QList<const FancyTab*> FancyTabIndex::match(const QString& query,
+                                            int limit,
+                                            const std::function<bool(const FancyTab*)>& accept) const
+{
+    const QString folded = query.trimmed().toCaseFolded();
+    if (folded.isEmpty() || limit <= 0)
+    {
+        return {};
+    }
+
+    // candidates share at least half of the query's trigrams ...
+    QHash<const FancyTab*, int> hits;
+    if (folded.size() >= 3)
+    {
+        const QList<quint64> keys = trigramKeys(folded);
+        for (const quint64 key : keys)
+        {
+            const auto posting = m_postings.constFind(key);
+            if (posting == m_postings.cend())
+            {
+                continue;
+            }
+            for (const FancyTab* tab : *posting)
+            {
+                ++hits[ tab ];
+            }
+        }
+        const int required = int(keys.size() + 1) / 2;
+        hits.removeIf([ required ](const QHash<const FancyTab*, int>::iterator it) { return it.value() < required; });
+    }
+
+    // ... or, failing that, a word starting like the query
+    for (qsizetype prefixLength = qMin<qsizetype>(folded.size(), 2); hits.isEmpty() && prefixLength > 0; --prefixLength)
+    {
+        const auto posting = m_postings.constFind(prefixKey(QStringView(folded).left(prefixLength)));
+        if (posting != m_postings.cend())
+        {
+            for (const FancyTab* tab : *posting)
+            {
+                hits.insert(tab, 0);
+            }
+        }
+    }
+
+    struct Match
+    {
+        int score;
+        const FancyTab* tab;
+    };
+    QList<Match> matches;
+    matches.reserve(hits.size());
+    for (auto it = hits.cbegin(); it != hits.cend(); ++it)
+    {
+        if (!accept(it.key()))
+        {
+            continue;
+        }
+        const int score = matchScore(m_labels.value(it.key()), folded, it.value());
+        if (score > 0)
+        {
+            matches.append({ score, it.key() });
+        }
+    }
+
+    const auto last = matches.begin() + qMin<qsizetype>(limit, matches.size());
+    std::partial_sort(matches.begin(),
+                      last,
+                      matches.end(),
+                      [](const Match& a, const Match& b) { return a.score > b.score; });
+
+    QList<const FancyTab*> result;
+    for (auto it = matches.begin(); it != last; ++it)
+    {
+        result.append(it->tab);
+    }
+    return result;
+}
+
+bool FancyTab::animated() const
+{
+    return static_cast<FancyTabBar*>(m_tabbar)->renderProfile() != FancyTabBar::LowBandwidthProfile;
+}
+
 void FancyTab::fadeIn()
 {
     m_animator.stop();
+    if (!animated())
+    {
+        setFader(1);
+        return;
+    }
     m_animator.setDuration(80);
     m_animator.setEndValue(1);
     m_animator.start();
@@ -120,6 +449,11 @@ void FancyTab::fadeIn()
 void FancyTab::fadeOut()
 {
     m_animator.stop();
+    if (!animated())
+    {
+        setFader(0);
+        return;
+    }
     m_animator.setDuration(160);
     m_animator.setEndValue(0);
     m_animator.start();
@@ -127,103 +461,284 @@ void FancyTab::fadeOut()
 
 void FancyTab::setFader(qreal value)
 {
-    m_fader = value;
-    m_tabbar->update();
+    if (m_fader == value)
+    {
+        return;
+    }
+    m_fader     = value;
+    auto tabBar = static_cast<FancyTabBar*>(m_tabbar);
+    tabBar->updateTab(index);
+}
+
+void FancyTab::setOffset(qreal value)
+{
+    if (m_offset == value)
+    {
+        return;
+    }
+    // repaint where the tab was and where it is now, not the whole bar
+    auto tabBar         = static_cast<FancyTabBar*>(m_tabbar);
+    const QRect rect    = tabBar->tabRect(tabBar->visibleIndex(index));
+    const QRect oldRect = rect.translated(tabBar->m_layout->flowOffset(qRound(m_offset)));
+    m_offset            = value;
+    tabBar->update(oldRect.united(rect.translated(tabBar->m_layout->flowOffset(qRound(m_offset)))));
+}
+
+void FancyTab::slideFrom(qreal offset)
+{
+    if (m_slideAnimator)
+    {
+        m_slideAnimator->stop();
+    }
+    if (!animated())
+    {
+        setOffset(0);
+        return;
+    }
+    if (!m_slideAnimator)
+    {
+        m_slideAnimator = std::make_unique<QPropertyAnimation>(this, "offset");
+        m_slideAnimator->setDuration(120);
+        m_slideAnimator->setEndValue(0);
+    }
+    m_slideAnimator->setStartValue(offset);
+    m_slideAnimator->start();
+}
+
+FancyTabUpdateQueue::~FancyTabUpdateQueue()
+{
+    Update* update = m_head.exchange(nullptr, std::memory_order_acquire);
+    while (update)
+    {
+        delete std::exchange(update, update->next);
+    }
+}
+
+void FancyTabUpdateQueue::push(Update* update)
+{
+    Update* head = m_head.load(std::memory_order_relaxed);
+    do
+    {
+        update->next = head;
+    } while (!m_head.compare_exchange_weak(head, update, std::memory_order_release, std::memory_order_relaxed));
+
+    // only the first post of a batch wakes the GUI thread
+    if (!head)
+    {
+        FancyTabBar* tabBar = m_tabBar;
+        QMetaObject::invokeMethod(tabBar, [ tabBar ]() { tabBar->scheduleFrame(); }, Qt::QueuedConnection);
+    }
+}
+
+FancyTabUpdateQueue::Update* FancyTabUpdateQueue::takeAll()
+{
+    // producers push onto the front, reverse to restore posting order
+    Update* update   = m_head.exchange(nullptr, std::memory_order_acquire);
+    Update* reversed = nullptr;
+    while (update)
+    {
+        Update* next = update->next;
+        update->next = reversed;
+        reversed     = update;
+        update       = next;
+    }
+    return reversed;
 }
 
+static QFont groupHeaderFont()
+{
+    QFont font = qApp->font();
+    font.setPointSize(7);
+    font.setBold(true);
+    return font;
+}
+
+static std::unique_ptr<FancyTabLayout> makeTabLayout(FancyTabBar::Arrangement arrangement,
+                                                     bool iconsOnly,
+                                                     FancyTabBar::RowSizing sizing);
+
 FancyTabBar::FancyTabBar(QWidget* parent)
     : QWidget(parent)
+    , m_layout(makeTabLayout(m_arrangement, m_iconsOnly, m_rowSizing))
 {
     setObjectName("FancyTabBar");
     setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Expanding);
     setAttribute(Qt::WA_Hover, true);
     setFocusPolicy(Qt::NoFocus);
     setMouseTracking(true);  // Needed for hover events
+
+    m_renderProfile = detectRenderProfile();
+
+    m_frameTimer.setSingleShot(true);
+    connect(&m_frameTimer, &QTimer::timeout, this, &FancyTabBar::flushPendingUpdates);
+
+    m_hoverSettleTimer.setSingleShot(true);
+    m_hoverSettleTimer.setInterval(300);
+    connect(&m_hoverSettleTimer,
+            &QTimer::timeout,
+            this,
+            [ this ]()
+            {
+                if (validIndex(m_hoverIndex))
+                {
+                    emit tabHoverSettled(m_hoverIndex);
+                }
+            });
+
+    m_warmUpTimer.setInterval(0);
+    connect(&m_warmUpTimer, &QTimer::timeout, this, &FancyTabBar::warmUpRenderCache);
+    connect(qApp, &QGuiApplication::screenAdded, this, &FancyTabBar::scheduleRenderCacheWarmUp);
 }
 
 QSize FancyTabBar::tabSizeHint(bool minimum) const
 {
-    int pWidth, pHeight;
-    if (m_iconsOnly)
+    // measuring every label is linear in the tab count, so both variants are cached
+    if (!m_tabSizeHintsValid)
     {
-        pWidth  = Core::Constants::MODEBAR_ICONSONLY_BUTTON_SIZE;
-        pHeight = Core::Constants::MODEBAR_ICONSONLY_BUTTON_SIZE / (minimum ? 3 : 1);
+        m_tabSizeHints[ 0 ] = m_layout->tabSizeHint(m_tabs, false);
+        m_tabSizeHints[ 1 ] = m_layout->tabSizeHint(m_tabs, true);
+        m_tabSizeHintsValid = true;
     }
-    else
+    return m_tabSizeHints[ minimum ];
+}
+
+FancyTabBar::RenderProfile FancyTabBar::detectRenderProfile()
+{
+    const QString platform = QGuiApplication::platformName();
+    if (platform == QLatin1String("vnc"))
     {
-        const QFont boldFont;
-        const QFontMetrics fm(boldFont);
-        const int spacing = 8;
-        const int width   = 60 + spacing + 2;
-        int maxLabelwidth = 0;
-        for (auto tab : std::as_const(m_tabs))
+        return LowBandwidthProfile;
+    }
+    if (platform == QLatin1String("xcb"))
+    {
+        // a host in front of the display number means the X server is
+        // remote, as with ssh -X (localhost:10.0) or host:0
+        const QByteArray display = qgetenv("DISPLAY");
+        const QByteArray host    = display.left(display.lastIndexOf(':'));
+        if (!host.isEmpty() && host != "unix" && !host.startsWith('/'))
         {
-            const int width = fm.horizontalAdvance(tab->text);
-            if (width > maxLabelwidth)
-            {
-                maxLabelwidth = width;
-            }
+            return LowBandwidthProfile;
         }
-        const int iconHeight = minimum ? 0 : 32;
-        pWidth               = qMax(width, maxLabelwidth + 4);
-        pHeight              = iconHeight + spacing + fm.height();
     }
+    return DefaultProfile;
+}
+
+void FancyTabBar::setRenderProfile(RenderProfile profile)
+{
+    if (profile == m_renderProfile)
+    {
+        return;
+    }
+    m_renderProfile = profile;
+    update();
+}
+
+// Composes color over background into an opaque color, so that fills don't
+// blend and produce intermediate shades.
+static QColor flattened(const QColor& color, const QColor& background)
+{
+    const qreal alpha = color.alphaF();
+    return QColor::fromRgbF(color.redF() * alpha + background.redF() * (1 - alpha),
+                            color.greenF() * alpha + background.greenF() * (1 - alpha),
+                            color.blueF() * alpha + background.blueF() * (1 - alpha));
+}
+
+QColor FancyTabBar::profileColor(const QColor& color, bool selected) const
+{
+    if (m_renderProfile != LowBandwidthProfile)
+    {
+        return color;
+    }
+    QColor background = getFancyTabBarBackgroundColor();
+    if (selected)
+    {
+        background = flattened(getFancyTabBarSelectedBackgroundColor(), background);
+    }
+    return flattened(color, background);
+}
 
-    return { pWidth, pHeight };
+void FancyTabBar::updateTab(int index)
+{
+    const int row = visibleIndex(index);
+    if (row != -1)
+    {
+        update(tabRect(row));
+    }
 }
 
 void FancyTabBar::paintEvent(QPaintEvent* event)
 {
+    for (const QRect& rect : event->region())
+    {
+        m_damagedPixels += qint64(rect.width()) * rect.height();
+    }
+
     QPainter p(this);
-    p.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::SmoothPixmapTransform, true);
+    p.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::SmoothPixmapTransform,
+                     m_renderProfile != LowBandwidthProfile);
 
     p.fillRect(event->rect(), getFancyTabBarBackgroundColor());
 
-    int visibleIndex        = 0;
-    int visibleCurrentIndex = -1;
-    for (int i = 0; i < count(); ++i)
+    // rows are ordered by position, so only the damaged ones are visited
+    const QList<Row>& layout         = rows();
+    const QRect area                 = event->rect();
+    const int draggedIndex           = m_dragging ? m_pressIndex : -1;
+    const auto [ firstRow, lastRow ] = m_layout->rowRange(layout, area);
+    int currentRow                   = -1;
+    for (int i = firstRow; i < lastRow; ++i)
     {
-        if (!m_tabs.at(i)->visible)
+        const Row& row = layout.at(i);
+        if (!row.rect.intersects(area))
         {
             continue;
         }
-        if (i != currentIndex())
+        if (row.header)
         {
-            paintTab(&p, i, visibleIndex, QIcon::Off);
+            m_layout->paintHeader(this, &p, row.rect, m_groups.at(row.index));
         }
-        else
+        else if (row.index == currentIndex())
+        {
+            currentRow = i;
+        }
+        else if (row.index != draggedIndex)
         {
-            visibleCurrentIndex = visibleIndex;
+            paintTab(&p, row.index, i, QIcon::Off);
         }
-        ++visibleIndex;
     }
 
     // paint active tab last, since it overlaps the neighbors
-    if (currentIndex() != -1)
+    if (currentRow != -1 && currentIndex() != draggedIndex)
+    {
+        paintTab(&p, currentIndex(), currentRow, QIcon::On);
+    }
+
+    // the dragged tab floats above everything else
+    if (draggedIndex != -1)
     {
-        paintTab(&p, currentIndex(), visibleCurrentIndex, QIcon::On);
+        paintTab(&p, draggedIndex, draggedTabRect(), draggedIndex == currentIndex() ? QIcon::On : QIcon::Off);
     }
 }
 
 // Handle hover events for mouse fade ins
 void FancyTabBar::mouseMoveEvent(QMouseEvent* event)
 {
-    int newHover     = -1;
-    int visibleIndex = 0;
-    for (int i = 0; i < count(); ++i)
+    if (m_pressIndex != -1 && (event->buttons() & Qt::LeftButton))
     {
-        if (!m_tabs.at(i)->visible)
+        if (!m_dragging && (event->pos() - m_pressPos).manhattanLength() >= QApplication::startDragDistance())
         {
-            continue;
+            m_dragging       = true;
+            m_dragPos        = m_layout->flowPosition(m_pressPos);
+            m_dragGrabOffset = m_dragPos - m_layout->flowPosition(tabRect(visibleIndex(m_pressIndex)).topLeft());
         }
-        const QRect area = tabRect(visibleIndex);
-        if (area.contains(event->pos()))
+        if (m_dragging)
         {
-            newHover = i;
-            break;
+            dragTabTo(event->pos());
+            return;
         }
-        ++visibleIndex;
     }
+
+    const int row      = rowAt(event->pos());
+    const int newHover = row != -1 && !rows().at(row).header ? rows().at(row).index : -1;
     if (newHover == m_hoverIndex)
     {
         return;
@@ -239,7 +754,12 @@ void FancyTabBar::mouseMoveEvent(QMouseEvent* event)
     if (validIndex(m_hoverIndex))
     {
         m_tabs[ m_hoverIndex ]->fadeIn();
-        m_hoverRect = tabRect(visibleIndex);
+        m_hoverRect = rows().at(row).rect;
+        m_hoverSettleTimer.start();
+    }
+    else
+    {
+        m_hoverSettleTimer.stop();
     }
 }
 
@@ -249,7 +769,19 @@ bool FancyTabBar::event(QEvent* event)
     {
         if (validIndex(m_hoverIndex))
         {
-            const QString tt = tabToolTip(m_hoverIndex);
+            const FancyTab* tab = m_tabs.at(m_hoverIndex);
+            const QString tt    = tabToolTip(m_hoverIndex);
+            if (tt.isNull() && m_toolTipProvider)
+            {
+                // shown by provideTabToolTip() once the answer arrives; a
+                // tab already waiting for one is not asked for again
+                if (!m_pendingToolTips.contains(tab))
+                {
+                    m_pendingToolTips.insert(tab);
+                    emit tabToolTipRequested(m_hoverIndex, tab->id);
+                }
+                return true;
+            }
             if (!tt.isEmpty())
             {
                 QToolTip::showText(static_cast<QHelpEvent*>(event)->globalPos(), tt, this);
@@ -274,6 +806,7 @@ void FancyTabBar::leaveEvent(QEvent* event)
     Q_UNUSED(event)
     m_hoverIndex = -1;
     m_hoverRect  = QRect();
+    m_hoverSettleTimer.stop();
     for (auto tab : std::as_const(m_tabs))
     {
         tab->fadeOut();
@@ -282,43 +815,184 @@ void FancyTabBar::leaveEvent(QEvent* event)
 
 QSize FancyTabBar::sizeHint() const
 {
-    const QSize sh = tabSizeHint();
-    return { sh.width(), sh.height() * int(m_tabs.count()) };
+    return m_layout->contentSize(rows(), m_tabs, m_groups, tabSizeHint(), size(), false);
 }
 
 QSize FancyTabBar::minimumSizeHint() const
 {
-    const QSize sh = tabSizeHint(true);
-    return { sh.width(), sh.height() * int(m_tabs.count()) };
+    return m_layout->contentSize(rows(), m_tabs, m_groups, tabSizeHint(true), size(), true);
 }
 
 QRect FancyTabBar::tabRect(int visibleIndex) const
 {
-    QSize sh = tabSizeHint();
-
-    if (sh.height() * m_tabs.count() > height())
+    const QList<Row>& layout = rows();
+    if (visibleIndex < 0 || visibleIndex >= layout.size())
     {
-        sh.setHeight(height() / m_tabs.count());
+        return {};
     }
+    return layout.at(visibleIndex).rect;
+}
 
-    return { 0, visibleIndex * sh.height(), sh.width(), sh.height() };
+// Rows follow tab order and a header sorts right before its group's first
+// tab, so both kinds of rows can be found by binary search on this key.
+int FancyTabBar::rowKey(const Row& row) const
+{
+    return row.header ? 2 * m_groups.at(row.index).first : 2 * row.index + 1;
 }
 
 int FancyTabBar::visibleIndex(int index) const
 {
-    int vIndex = 0;
-    for (int i = 0; i < m_tabs.size(); ++i)
+    if (!validIndex(index))
     {
-        if (i == index)
-        {
-            return vIndex;
-        }
-        if (m_tabs.at(i)->visible)
-        {
-            ++vIndex;
-        }
+        return -1;
     }
-    return vIndex;
+
+    const QList<Row>& layout = rows();
+    const auto before        = [ this ](const Row& entry, int key) { return rowKey(entry) < key; };
+    const auto row           = std::lower_bound(layout.cbegin(), layout.cend(), 2 * index + 1, before);
+    if (row == layout.cend() || row->header || row->index != index)
+    {
+        return -1;
+    }
+    return int(row - layout.cbegin());
+}
+
+int FancyTabBar::headerRow(int group) const
+{
+    const QList<Row>& layout = rows();
+    const int first          = m_groups.at(group).first;
+    const auto before        = [ this ](const Row& entry, int key) { return rowKey(entry) < key; };
+    // empty groups may share their first index with the next group
+    for (auto row = std::lower_bound(layout.cbegin(), layout.cend(), 2 * first, before);
+         row != layout.cend() && row->header && m_groups.at(row->index).first == first;
+         ++row)
+    {
+        if (row->index == group)
+        {
+            return int(row - layout.cbegin());
+        }
+    }
+    return -1;
+}
+
+int FancyTabBar::rowAt(const QPoint& pos) const
+{
+    return m_layout->rowAt(rows(), pos);
+}
+
+const QList<FancyTabBar::Row>& FancyTabBar::rows() const
+{
+    if (!m_rowsValid)
+    {
+        layoutRows();
+    }
+    return m_rows;
+}
+
+void FancyTabBar::layoutRows() const
+{
+    m_rows.clear();
+    m_layoutTabRows    = 0;
+    m_layoutHeaderRows = 0;
+
+    const auto addTabs = [ this ](int from, int to)
+    {
+        for (int i = from; i < to; ++i)
+        {
+            if (m_tabs.at(i)->visible)
+            {
+                m_rows.append({ i, false, {} });
+                ++m_layoutTabRows;
+            }
+        }
+    };
+
+    // collapsed groups contribute their header only, their tabs are skipped
+    int next = 0;
+    for (int group = 0; group < m_groups.count(); ++group)
+    {
+        const FancyTabGroup& entry = m_groups.at(group);
+        addTabs(next, entry.first);
+        m_rows.append({ group, true, {} });
+        ++m_layoutHeaderRows;
+        if (!entry.collapsed)
+        {
+            addTabs(entry.first, entry.first + entry.count);
+        }
+        next = entry.first + entry.count;
+    }
+    addTabs(next, int(m_tabs.count()));
+
+    m_layout->placeRows(m_rows, m_tabs, m_groups, tabSizeHint(), size());
+    m_rowsValid = true;
+}
+
+void FancyTabBar::invalidateLayout()
+{
+    m_rowsValid = false;
+}
+
+void FancyTabBar::invalidateTabSizeHint()
+{
+    m_tabSizeHintsValid = false;
+    invalidateLayout();
+}
+
+static int groupHeaderHeight()
+{
+    return QFontMetrics(groupHeaderFont()).height() + 6;
+}
+
+void FancyTabBar::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
+    // rows shrink when the bar is too short for all of them
+    invalidateLayout();
+    if (m_arrangement == MultiColumnArrangement && event->oldSize().height() != height())
+    {
+        // the number of columns follows the height
+        updateGeometry();
+    }
+}
+
+int FancyTabBar::tabAt(const QPoint& pos) const
+{
+    const int row = rowAt(pos);
+    return row != -1 && !rows().at(row).header ? rows().at(row).index : -1;
+}
+
+QRect FancyTabBar::draggedTabRect() const
+{
+    const QRect rect   = tabRect(visibleIndex(m_pressIndex));
+    const int range    = qMax(0, m_layout->flowExtent(this->rect()) - m_layout->flowExtent(rect));
+    const int position = qBound(0, m_dragPos - m_dragGrabOffset, range);
+    return rect.translated(m_layout->flowOffset(position - m_layout->flowPosition(rect.topLeft())));
+}
+
+void FancyTabBar::dragTabTo(const QPoint& pos)
+{
+    const QRect oldRect = draggedTabRect();
+    m_dragPos           = m_layout->flowPosition(pos);
+    const QRect newRect = draggedTabRect();
+    update(oldRect.united(newRect));
+
+    const int target = tabAt(newRect.center());
+    if (target == -1 || target == m_pressIndex)
+    {
+        return;
+    }
+
+    // the tabs the dragged one passes over slide by one row towards its old slot
+    const int rowExtent = m_layout->flowExtent(newRect);
+    const int step      = target > m_pressIndex ? 1 : -1;
+    for (int i = m_pressIndex + step; i != target + step; i += step)
+    {
+        if (visibleIndex(i) != -1)
+        {
+            m_tabs.at(i)->slideFrom(step * rowExtent);
+        }
+    }
+    moveTab(m_pressIndex, target);
 }
 
 void FancyTabBar::contextMenuEvent(QContextMenuEvent* event)
@@ -333,207 +1007,1433 @@ void FancyTabBar::contextMenuEvent(QContextMenuEvent* event)
 void FancyTabBar::mousePressEvent(QMouseEvent* event)
 {
     event->accept();
-    int visibleIndex = 0;
-    for (int index = 0; index < m_tabs.count(); ++index)
+    const int row = rowAt(event->pos());
+    if (row != -1 && rows().at(row).header)
     {
-        if (!m_tabs.at(index)->visible)
+        if (event->button() == Qt::LeftButton)
         {
-            continue;
+            const int group = rows().at(row).index;
+            setTabGroupCollapsed(group, !m_groups.at(group).collapsed);
+        }
+        return;
+    }
+    if (row != -1)
+    {
+        const int index  = rows().at(row).index;
+        const QRect rect = rows().at(row).rect;
+        if (isTabEnabled(index) && event->button() == Qt::LeftButton)
+        {
+            if (m_tabs.at(index)->hasMenu && m_layout->hitsMenuButton(rect, event->pos()))
+            {
+                // menu arrow clicked
+                emit menuTriggered(index, event);
+            }
+            else
+            {
+                if (index != m_currentIndex)
+                {
+                    emit currentAboutToChange(index);
+                    const int previousIndex = m_currentIndex;
+                    m_currentIndex          = index;
+                    updateTab(previousIndex);
+                    updateTab(m_currentIndex);
+                    emit currentChanged(m_currentIndex);
+                }
+                if (m_movable)
+                {
+                    m_pressIndex = index;
+                    m_pressPos   = event->pos();
+                }
+            }
+        }
+        else if (event->button() == Qt::RightButton)
+        {
+            emit menuTriggered(index, event);
+        }
+        return;
+    }
+    // not in a mode button
+    if (event->button() == Qt::RightButton)
+    {
+        emit menuTriggered(-1, event);
+    }
+}
+
+void FancyTabBar::mouseReleaseEvent(QMouseEvent* event)
+{
+    Q_UNUSED(event)
+    if (m_dragging && validIndex(m_pressIndex))
+    {
+        // settle the dropped tab into its slot
+        const QRect slot = tabRect(visibleIndex(m_pressIndex));
+        const QRect drop = draggedTabRect();
+        m_tabs.at(m_pressIndex)->slideFrom(m_layout->flowPosition(drop.topLeft())
+                                           - m_layout->flowPosition(slot.topLeft()));
+    }
+    m_dragging   = false;
+    m_pressIndex = -1;
+}
+
+static QFont badgeFont()
+{
+    QFont font = qApp->font();
+    font.setPointSize(7);
+    font.setBold(true);
+    return font;
+}
+
+static void paintBadge(QPainter* painter,
+                       const QRect& rect,
+                       const QString& text,
+                       const QColor& color,
+                       const QColor& textColor)
+{
+    painter->save();
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(color);
+    const qreal radius = rect.height() / 2.0;
+    painter->drawRoundedRect(rect, radius, radius);
+    if (!text.isEmpty())
+    {
+        painter->setPen(textColor);
+        painter->setFont(badgeFont());
+        painter->drawText(rect, Qt::AlignCenter, text);
+    }
+    painter->restore();
+}
+
+static void paintIcon(QPainter* painter,
+                      const QRect& rect,
+                      const QIcon& icon,
+                      QIcon::State iconState,
+                      bool enabled,
+                      bool selected,
+                      QColor c,
+                      FancyRenderCache* cache,
+                      bool lowBandwidth)
+{
+    painter->save();
+    const QIcon::Mode iconMode = enabled ? (selected ? QIcon::Active : QIcon::Normal) : QIcon::Disabled;
+    QRect iconRect(0, 0, Core::Constants::MODEBAR_ICON_SIZE, Core::Constants::MODEBAR_ICON_SIZE);
+    iconRect.moveCenter(rect.center());
+    iconRect = iconRect.intersected(rect);
+
+    // the disabled icon mode alone marks the tab when nothing may blend
+    if (!enabled && !lowBandwidth)
+    {
+        painter->setOpacity(0.7);
+    }
+
+    const qreal devicePixelRatio = painter->device()->devicePixelRatio();
+    painter->drawPixmap(iconRect,
+                        tintedIconPixmap(cache, icon, iconRect.size(), devicePixelRatio, iconMode, iconState, c));
+
+    painter->restore();
+}
+
+namespace {
+
+// Flow: the direction rows follow and whether they wrap into columns.
+struct VerticalFlow
+{
+    static constexpr const char* name = "vertical";
+    static constexpr bool horizontal  = false;
+    static constexpr bool wraps       = false;
+};
+
+struct HorizontalFlow
+{
+    static constexpr const char* name = "horizontal";
+    static constexpr bool horizontal  = true;
+    static constexpr bool wraps       = false;
+};
+
+struct ColumnFlow
+{
+    static constexpr const char* name = "columns";
+    static constexpr bool horizontal  = false;
+    static constexpr bool wraps       = true;
+};
+
+// Content: icons only, or icon and label.
+struct IconContent
+{
+    static constexpr const char* name = "icons";
+    static constexpr bool iconsOnly   = true;
+};
+
+struct TextContent
+{
+    static constexpr const char* name = "text";
+    static constexpr bool iconsOnly   = false;
+};
+
+// Sizing: one extent for all tabs, or each tab measured from its label.
+struct FixedSizing
+{
+    static constexpr const char* name = "fixed";
+    static constexpr bool measured    = false;
+};
+
+struct MeasuredSizing
+{
+    static constexpr const char* name = "measured";
+    static constexpr bool measured    = true;
+};
+
+}  // namespace
+
+template <typename Flow, typename Content, typename Sizing>
+class FancyTabLayoutPolicy final : public FancyTabLayout
+{
+    // labels only change the extent of text tabs with measured sizing
+    static constexpr bool kMeasuresLabels = Sizing::measured && !Content::iconsOnly;
+
+public:
+    FancyTabLayoutPolicy()
+        : m_name(QByteArray(Flow::name) + '/' + Content::name + '/' + Sizing::name)
+    {
+    }
+
+    const char* name() const override { return m_name.constData(); }
+
+    QSize tabSizeHint(const QList<FancyTab*>& tabs, bool minimum) const override
+    {
+        if constexpr (Content::iconsOnly)
+        {
+            const int size    = Core::Constants::MODEBAR_ICONSONLY_BUTTON_SIZE;
+            const int minSize = Core::Constants::MODEBAR_ICONSONLY_BUTTON_SIZE / 3;
+            return Flow::horizontal ? QSize(minimum ? minSize : size, size) : QSize(size, minimum ? minSize : size);
+        }
+        else
+        {
+            const QFont boldFont;
+            const QFontMetrics fm(boldFont);
+            const int spacing    = 8;
+            const int iconHeight = 32;
+            const int height     = iconHeight + spacing + fm.height();
+            if constexpr (Flow::horizontal)
+            {
+                // the bar keeps its height, tabs give up width instead
+                if (minimum)
+                {
+                    return { spacing + fm.height(), height };
+                }
+                if constexpr (Sizing::measured)
+                {
+                    // each tab measures its own label in placeRows()
+                    return { kMinimumMeasuredTabWidth, height };
+                }
+            }
+
+            int maxLabelwidth = 0;
+            for (auto tab : tabs)
+            {
+                const int width = fm.horizontalAdvance(tab->text);
+                if (width > maxLabelwidth)
+                {
+                    maxLabelwidth = width;
+                }
+            }
+            const int width = qMax(60 + spacing + 2, maxLabelwidth + 4);
+            return { width, !Flow::horizontal && minimum ? spacing + fm.height() : height };
         }
-        const QRect rect = tabRect(visibleIndex);
-        if (rect.contains(event->pos()))
+    }
+
+    void placeRows(QList<FancyTabRow>& rows,
+                   const QList<FancyTab*>& tabs,
+                   const QList<FancyTabGroup>& groups,
+                   const QSize& tabSize,
+                   const QSize& barSize) const override
+    {
+        Extents extents;
+        measure(extents, rows, tabs, groups, tabSize, false);
+        const int thickness = Flow::horizontal ? tabSize.height() : tabSize.width();
+
+        if constexpr (Flow::wraps)
         {
-            if (isTabEnabled(index) && event->button() == Qt::LeftButton)
+            // rows run down a column and continue at the top of the next one
+            int x = 0;
+            int y = 0;
+            for (qsizetype i = 0; i < rows.size(); ++i)
             {
-                if (m_tabs.at(index)->hasMenu && (!m_iconsOnly && rect.right() - event->pos().x() <= kMenuButtonWidth))
+                if (y > 0 && y + extents.rows[ i ] > barSize.height())
                 {
-                    // menu arrow clicked
-                    emit menuTriggered(index, event);
+                    x += thickness;
+                    y = 0;
                 }
-                else
+                rows[ i ].rect = QRect(x, y, thickness, extents.rows[ i ]);
+                y += extents.rows[ i ];
+            }
+        }
+        else
+        {
+            // tabs shrink when the bar is too short for all of them, headers keep their size
+            const int available = Flow::horizontal ? barSize.width() : barSize.height();
+            if (extents.tabRows > 0 && extents.tabSpace + extents.headerSpace > available)
+            {
+                const int room = qMax(0, available - extents.headerSpace);
+                for (qsizetype i = 0; i < rows.size(); ++i)
                 {
-                    if (index != m_currentIndex)
+                    if (!rows.at(i).header)
                     {
-                        emit currentAboutToChange(index);
-                        m_currentIndex = index;
-                        update();
-                        emit currentChanged(m_currentIndex);
+                        if constexpr (kMeasuresLabels)
+                        {
+                            extents.rows[ i ] = int(qint64(extents.rows[ i ]) * room / extents.tabSpace);
+                        }
+                        else
+                        {
+                            extents.rows[ i ] = room / extents.tabRows;
+                        }
                     }
                 }
             }
-            else if (event->button() == Qt::RightButton)
+
+            int position = 0;
+            for (qsizetype i = 0; i < rows.size(); ++i)
             {
-                emit menuTriggered(index, event);
+                const int extent = extents.rows[ i ];
+                rows[ i ].rect   = Flow::horizontal ? QRect(position, 0, extent, thickness)
+                                                    : QRect(0, position, thickness, extent);
+                position += extent;
             }
-            return;
         }
-        ++visibleIndex;
     }
-    // not in a mode button
-    if (event->button() == Qt::RightButton)
+
+    QSize contentSize(const QList<FancyTabRow>& rows,
+                      const QList<FancyTab*>& tabs,
+                      const QList<FancyTabGroup>& groups,
+                      const QSize& tabSize,
+                      const QSize& barSize,
+                      bool minimum) const override
     {
-        emit menuTriggered(-1, event);
+        Extents extents;
+        measure(extents, rows, tabs, groups, tabSize, minimum);
+        const int thickness = Flow::horizontal ? tabSize.height() : tabSize.width();
+        const int length    = extents.tabSpace + extents.headerSpace;
+
+        if constexpr (Flow::wraps)
+        {
+            // at least one row has to fit a column, the columns then follow the height
+            const int height = barSize.isEmpty() ? length : barSize.height();
+            int tallest      = 0;
+            int columns      = 1;
+            int y            = 0;
+            for (const int extent : std::as_const(extents.rows))
+            {
+                tallest = qMax(tallest, extent);
+                if (y > 0 && y + extent > height)
+                {
+                    ++columns;
+                    y = 0;
+                }
+                y += extent;
+            }
+            return minimum ? QSize(thickness, tallest) : QSize(columns * thickness, length);
+        }
+        else
+        {
+            return Flow::horizontal ? QSize(length, thickness) : QSize(thickness, length);
+        }
+    }
+
+    int rowAt(const QList<FancyTabRow>& rows, const QPoint& pos) const override
+    {
+        const auto before = [](const QPoint& point, const FancyTabRow& row)
+        {
+            if constexpr (Flow::wraps)
+            {
+                // columns left to right, rows top to bottom within a column
+                return point.x() < row.rect.left() || (point.x() <= row.rect.right() && point.y() < row.rect.top());
+            }
+            else
+            {
+                return Flow::horizontal ? point.x() < row.rect.left() : point.y() < row.rect.top();
+            }
+        };
+        const auto row = std::upper_bound(rows.cbegin(), rows.cend(), pos, before);
+        if (row == rows.cbegin() || !std::prev(row)->rect.contains(pos))
+        {
+            return -1;
+        }
+        return int(std::prev(row) - rows.cbegin());
+    }
+
+    std::pair<int, int> rowRange(const QList<FancyTabRow>& rows, const QRect& area) const override
+    {
+        // wrapped rows are only ordered by column, the caller skips those outside area
+        const auto before = [](const FancyTabRow& row, int edge) { return orderEnd(row.rect) < edge; };
+        const auto after  = [](int edge, const FancyTabRow& row) { return edge < orderStart(row.rect); };
+        const auto first  = std::lower_bound(rows.cbegin(), rows.cend(), orderStart(area), before);
+        const auto last   = std::upper_bound(first, rows.cend(), orderEnd(area), after);
+        return { int(first - rows.cbegin()), int(last - rows.cbegin()) };
+    }
+
+    bool stacksUniformRows() const override { return !Flow::horizontal && !Flow::wraps && !kMeasuresLabels; }
+
+    int flowPosition(const QPoint& pos) const override { return Flow::horizontal ? pos.x() : pos.y(); }
+
+    int flowExtent(const QRect& rect) const override { return Flow::horizontal ? rect.width() : rect.height(); }
+
+    QPoint flowOffset(int distance) const override
+    {
+        return Flow::horizontal ? QPoint(distance, 0) : QPoint(0, distance);
+    }
+
+    void paintTab(const FancyTabBar* bar,
+                  QPainter* painter,
+                  const QRect& rect,
+                  const FancyTab* tab,
+                  QIcon::State iconState,
+                  bool enabled,
+                  bool selected) const override
+    {
+        if constexpr (Content::iconsOnly)
+        {
+            paintIcon(painter,
+                      rect,
+                      tab->icon,
+                      iconState,
+                      enabled,
+                      selected,
+                      bar->getFancyTabBarIconColor(),
+                      bar->m_renderCache.get(),
+                      bar->m_renderProfile == FancyTabBar::LowBandwidthProfile);
+        }
+        else
+        {
+            bar->paintIconAndText(painter, rect, tab->icon, iconState, tab->text, enabled, selected);
+        }
+
+        if (selected)
+        {
+            QRect accentRect = rect;
+            if constexpr (Flow::horizontal)
+            {
+                accentRect.setTop(rect.bottom() - 1);
+            }
+            else
+            {
+                accentRect.setWidth(2);
+            }
+            painter->fillRect(accentRect, bar->profileColor(bar->getFancyToolButtonHighlightColor(), true));
+        }
+
+        // menu arrow
+        if constexpr (!Content::iconsOnly)
+        {
+            if (tab->hasMenu)
+            {
+                QStyleOption opt;
+                opt.initFrom(bar);
+                opt.rect = rect.adjusted(rect.width() - kMenuButtonWidth, 0, -8, 0);
+                drawArrow(Flow::horizontal ? QStyle::PE_IndicatorArrowDown : QStyle::PE_IndicatorArrowRight,
+                          painter,
+                          &opt,
+                          bar->profileColor(bar->getFancyTabWidgetDisabledSelectedTextColor(), selected),
+                          bar->profileColor(bar->getFancyTabBarIconColor(), selected),
+                          bar->m_renderCache.get());
+            }
+        }
+    }
+
+    void paintHeader(const FancyTabBar* bar,
+                     QPainter* painter,
+                     const QRect& rect,
+                     const FancyTabGroup& group) const override
+    {
+        painter->save();
+
+        QStyleOption opt;
+        opt.initFrom(bar);
+        opt.rect = QRect(rect.left() + 4, rect.top(), 8, rect.height());
+        drawArrow(group.collapsed ? QStyle::PE_IndicatorArrowRight : QStyle::PE_IndicatorArrowDown,
+                  painter,
+                  &opt,
+                  bar->profileColor(bar->getFancyTabWidgetDisabledSelectedTextColor(), false),
+                  bar->profileColor(bar->getFancyTabWidgetEnabledUnselectedTextColor(), false),
+                  bar->m_renderCache.get());
+
+        if constexpr (!Content::iconsOnly)
+        {
+            QFont font = groupHeaderFont();
+            if (bar->m_renderProfile == FancyTabBar::LowBandwidthProfile)
+            {
+                font.setStyleStrategy(QFont::NoAntialias);
+            }
+            painter->setFont(font);
+            painter->setPen(bar->profileColor(bar->getFancyTabWidgetEnabledUnselectedTextColor(), false));
+            const QRect textRect = rect.adjusted(kHeaderTextIndent, 0, -kHeaderTextMargin, 0);
+            painter->drawText(textRect,
+                              Qt::AlignLeft | Qt::AlignVCenter,
+                              painter->fontMetrics().elidedText(group.name, Qt::ElideRight, textRect.width()));
+        }
+        painter->restore();
+    }
+
+    bool hitsMenuButton(const QRect& rect, const QPoint& pos) const override
+    {
+        if constexpr (Content::iconsOnly)
+        {
+            return false;
+        }
+        else
+        {
+            return rect.right() - pos.x() <= kMenuButtonWidth;
+        }
+    }
+
+private:
+    struct Extents
+    {
+        QVarLengthArray<int, 64> rows;  // along the flow, per row
+        int tabSpace    = 0;
+        int headerSpace = 0;
+        int tabRows     = 0;
+    };
+
+    // Rows are ordered along this axis: the flow, or the columns when wrapping.
+    static int orderStart(const QRect& rect) { return Flow::horizontal || Flow::wraps ? rect.left() : rect.top(); }
+
+    static int orderEnd(const QRect& rect) { return Flow::horizontal || Flow::wraps ? rect.right() : rect.bottom(); }
+
+    void measure(Extents& extents,
+                 const QList<FancyTabRow>& rows,
+                 const QList<FancyTab*>& tabs,
+                 const QList<FancyTabGroup>& groups,
+                 const QSize& tabSize,
+                 bool minimum) const
+    {
+        const QFont boldFont;
+        const QFontMetrics fm(boldFont);
+        const QFontMetrics headerMetrics(groupHeaderFont());
+        extents.rows.reserve(rows.size());
+        for (const FancyTabRow& row : rows)
+        {
+            if (row.header)
+            {
+                const int extent = headerExtent(groups.at(row.index), headerMetrics);
+                extents.rows.append(extent);
+                extents.headerSpace += extent;
+            }
+            else
+            {
+                const int extent = tabExtent(tabs.at(row.index), tabSize, fm, minimum);
+                extents.rows.append(extent);
+                extents.tabSpace += extent;
+                ++extents.tabRows;
+            }
+        }
+    }
+
+    static int headerExtent(const FancyTabGroup& group, const QFontMetrics& headerMetrics)
+    {
+        if constexpr (!Flow::horizontal)
+        {
+            return groupHeaderHeight();
+        }
+        else if constexpr (Content::iconsOnly)
+        {
+            return kMenuButtonWidth;  // room for the collapse arrow
+        }
+        else
+        {
+            return headerMetrics.horizontalAdvance(group.name) + kHeaderTextIndent + kHeaderTextMargin;
+        }
+    }
+
+    static int tabExtent(const FancyTab* tab, const QSize& tabSize, const QFontMetrics& fm, bool minimum)
+    {
+        if constexpr (!kMeasuresLabels)
+        {
+            return Flow::horizontal ? tabSize.width() : tabSize.height();
+        }
+        else if constexpr (Flow::horizontal)
+        {
+            const int menuWidth = tab->hasMenu ? kMenuButtonWidth : 0;
+            return minimum ? tabSize.width()
+                           : qMax(kMinimumMeasuredTabWidth, fm.horizontalAdvance(tab->text) + 16 + menuWidth);
+        }
+        else
+        {
+            // labels with line breaks get taller rows
+            const QRect textRect = fm.boundingRect(QRect(0, 0, tabSize.width(), 0), Qt::TextWordWrap, tab->text);
+            return tabSize.height() - fm.height() + qMax(fm.height(), textRect.height());
+        }
+    }
+
+    const QByteArray m_name;
+};
+
+template <typename Flow, typename Content>
+static std::unique_ptr<FancyTabLayout> makeTabLayout(FancyTabBar::RowSizing sizing)
+{
+    if (sizing == FancyTabBar::MeasuredRowSize)
+    {
+        return std::make_unique<FancyTabLayoutPolicy<Flow, Content, MeasuredSizing>>();
+    }
+    return std::make_unique<FancyTabLayoutPolicy<Flow, Content, FixedSizing>>();
+}
+
+template <typename Flow>
+static std::unique_ptr<FancyTabLayout> makeTabLayout(bool iconsOnly, FancyTabBar::RowSizing sizing)
+{
+    return iconsOnly ? makeTabLayout<Flow, IconContent>(sizing) : makeTabLayout<Flow, TextContent>(sizing);
+}
+
+// Picks the specialization for a configuration; there are twelve of them.
+static std::unique_ptr<FancyTabLayout> makeTabLayout(FancyTabBar::Arrangement arrangement,
+                                                     bool iconsOnly,
+                                                     FancyTabBar::RowSizing sizing)
+{
+    switch (arrangement)
+    {
+    case FancyTabBar::HorizontalArrangement:
+        return makeTabLayout<HorizontalFlow>(iconsOnly, sizing);
+    case FancyTabBar::MultiColumnArrangement:
+        return makeTabLayout<ColumnFlow>(iconsOnly, sizing);
+    case FancyTabBar::VerticalArrangement:
+        break;
+    }
+    return makeTabLayout<VerticalFlow>(iconsOnly, sizing);
+}
+
+void FancyTabBar::paintIconAndText(QPainter* painter,
+                                   const QRect& rect,
+                                   const QIcon& icon,
+                                   QIcon::State iconState,
+                                   const QString& text,
+                                   bool enabled,
+                                   bool selected) const
+{
+    painter->save();
+    const bool lowBandwidth = m_renderProfile == LowBandwidthProfile;
+    QFont boldFont          = qApp->font();
+    boldFont.setPointSize(8);
+    boldFont.setBold(true);
+    if (lowBandwidth)
+    {
+        boldFont.setStyleStrategy(QFont::NoAntialias);
+    }
+    painter->setFont(boldFont);
+
+    const bool drawIcon = rect.height() > 36;
+    if (drawIcon)
+    {
+        const int textHeight = painter->fontMetrics().boundingRect(rect, Qt::TextWordWrap, text).height();
+        const QRect tabIconRect(rect.adjusted(0, 4, 0, -textHeight));
+        const QIcon::Mode iconMode = enabled ? (selected ? QIcon::Active : QIcon::Normal) : QIcon::Disabled;
+        QRect iconRect(0, 0, Core::Constants::MODEBAR_ICON_SIZE, Core::Constants::MODEBAR_ICON_SIZE);
+        iconRect.moveCenter(tabIconRect.center());
+        iconRect = iconRect.intersected(tabIconRect);
+        if (!enabled && !lowBandwidth)
+        {
+            painter->setOpacity(0.7);
+        }
+
+        const qreal devicePixelRatio = painter->device()->devicePixelRatio();
+        painter->drawPixmap(iconRect,
+                            tintedIconPixmap(m_renderCache.get(),
+                                             icon,
+                                             iconRect.size(),
+                                             devicePixelRatio,
+                                             iconMode,
+                                             iconState,
+                                             getFancyTabBarIconColor()));
+    }
+
+    painter->setOpacity(1.0);  // FIXME: was 0.7 before?
+    QColor textColor;
+    if (enabled)
+    {
+        textColor = selected ? getFancyTabWidgetEnabledSelectedTextColor()
+                             : getFancyTabWidgetEnabledUnselectedTextColor();
+    }
+    else
+    {
+        textColor = selected ? getFancyTabWidgetDisabledSelectedTextColor()
+                             : getFancyTabWidgetDisabledUnselectedTextColor();
+    }
+    painter->setPen(profileColor(textColor, selected));
+
+    painter->translate(0, -1);
+    QRect tabTextRect(rect);
+    tabTextRect.translate(0, drawIcon ? -2 : 1);
+    const int textFlags = Qt::AlignCenter | (drawIcon ? Qt::AlignBottom : Qt::AlignVCenter) | Qt::TextWordWrap;
+    painter->drawText(tabTextRect, textFlags, text);
+    painter->restore();
+}
+
+void FancyTabBar::paintTab(QPainter* painter, int tabIndex, int visibleIndex, QIcon::State iconState) const
+{
+    if (!validIndex(tabIndex))
+    {
+        qWarning("invalid index");
+        return;
+    }
+    const QPoint offset = m_layout->flowOffset(qRound(m_tabs.at(tabIndex)->offset()));
+    paintTab(painter, tabIndex, tabRect(visibleIndex).translated(offset), iconState);
+}
+
+void FancyTabBar::paintTab(QPainter* painter, int tabIndex, const QRect& rect, QIcon::State iconState) const
+{
+    painter->save();
+
+    const FancyTab* tab     = m_tabs.at(tabIndex);
+    const bool selected     = (tabIndex == m_currentIndex);
+    const bool enabled      = isTabEnabled(tabIndex);
+    const bool lowBandwidth = m_renderProfile == LowBandwidthProfile;
+
+    if (selected)
+    {
+        painter->fillRect(rect,
+                          lowBandwidth
+                              ? flattened(getFancyTabBarSelectedBackgroundColor(), getFancyTabBarBackgroundColor())
+                              : getFancyTabBarSelectedBackgroundColor());
+    }
+
+    const qreal fader = tab->fader();
+    if (fader > 0 && !selected && enabled)
+    {
+        if (lowBandwidth)
+        {
+            // hover is either on or off here, see FancyTab::fadeIn()
+            painter->fillRect(rect, flattened(getFancyToolButtonHoverColor(), getFancyTabBarBackgroundColor()));
+        }
+        else
+        {
+            painter->save();
+            painter->setOpacity(fader);
+            painter->fillRect(rect, getFancyToolButtonHoverColor());
+            painter->restore();
+        }
+    }
+
+    m_layout->paintTab(this, painter, rect, tab, iconState, enabled, selected);
+
+    const QRect badgeArea = badgeRect(rect, tab->badge, tab->badgeColor);
+    if (!badgeArea.isEmpty())
+    {
+        paintBadge(painter,
+                   badgeArea,
+                   tab->badge,
+                   tab->badgeColor.isValid() ? tab->badgeColor : getFancyTabBarBadgeColor(),
+                   getFancyTabBarBadgeTextColor());
+    }
+    painter->restore();
+}
+
+void FancyTabBar::setCurrentIndex(int index)
+{
+    if ((index == -1 || isTabEnabled(index)) && index != m_currentIndex)
+    {
+        revealTab(index);
+        emit currentAboutToChange(index);
+        const int previousIndex = m_currentIndex;
+        m_currentIndex          = index;
+        updateTab(previousIndex);
+        updateTab(m_currentIndex);
+        emit currentChanged(m_currentIndex);
+    }
+}
+
+// Expands the group holding the tab, so that a tab selected by other means
+// than a click, e.g. the quick switcher, has a row to show the selection.
+void FancyTabBar::revealTab(int index)
+{
+    const int group = validIndex(index) ? tabGroup(index) : -1;
+    if (group != -1 && m_groups.at(group).collapsed)
+    {
+        setTabGroupCollapsed(group, false);
+    }
+}
+
+void FancyTabBar::removeTab(int index)
+{
+    FancyTab* tab = m_tabs.takeAt(index);
+    m_tabsById.remove(tab->id);
+    renumberTabs(index, int(m_tabs.count()) - 1);
+    m_labelIndex.remove(tab);
+    m_toolTips.remove(tab);
+    m_toolTipCache.remove(tab);
+    m_pendingToolTips.remove(tab);
+    adjustGroupsForRemove(index);
+    invalidateTabSizeHint();
+    if (tab->badgePending)
+    {
+        m_pendingBadges.removeOne(tab);
+    }
+    delete tab;
+
+    const bool currentRemoved = m_currentIndex == index;
+    if (currentRemoved)
+    {
+        m_currentIndex = -1;
+    }
+    else if (m_currentIndex > index)
+    {
+        --m_currentIndex;
+    }
+    if (m_hoverIndex == index)
+    {
+        m_hoverIndex = -1;
+        m_hoverRect  = QRect();
+    }
+    else if (m_hoverIndex > index)
+    {
+        --m_hoverIndex;
+    }
+    if (m_pressIndex == index)
+    {
+        m_pressIndex = -1;
+        m_dragging   = false;
+    }
+    else if (m_pressIndex > index)
+    {
+        --m_pressIndex;
+    }
+    updateGeometry();
+    update();
+
+    if (currentRemoved)
+    {
+        // the tab that took the removed one's place, else the nearest before
+        // it; like findTabs(), tabs of collapsed groups count and get revealed
+        const auto selectable = [ this ](int i) { return isTabEnabled(i) && m_tabs.at(i)->visible; };
+        int next              = index;
+        while (next < count() && !selectable(next))
+        {
+            ++next;
+        }
+        if (next == count())
+        {
+            next = index - 1;
+            while (next >= 0 && !selectable(next))
+            {
+                --next;
+            }
+        }
+        revealTab(next);
+        emit currentAboutToChange(next);
+        m_currentIndex = next;
+        emit currentChanged(m_currentIndex);
+    }
+}
+
+void FancyTabBar::moveTab(int from, int to)
+{
+    if (!validIndex(from) || !validIndex(to) || from == to)
+    {
+        return;
+    }
+
+    const int firstVisibleIndex = visibleIndex(qMin(from, to));
+    const int lastVisibleIndex  = visibleIndex(qMax(from, to));
+    const qsizetype rowCount    = rows().size();
+    const int group             = tabGroup(from);
+
+    m_tabs.move(from, to);
+    renumberTabs(qMin(from, to), qMax(from, to));
+    // A move within the tab's own group, onto its first or last slot
+    // included, only permutes the group's range. Any other move leaves the
+    // group and joins another one only strictly inside it, like an insert.
+    if (group == -1 || to < m_groups.at(group).first || to >= m_groups.at(group).first + m_groups.at(group).count)
+    {
+        adjustGroupsForRemove(from);
+        adjustGroupsForInsert(to);
+    }
+    invalidateLayout();
+
+    const auto remap = [ from, to ](int index) -> int
+    {
+        if (index == from)
+        {
+            return to;
+        }
+        if (from < to && index > from && index <= to)
+        {
+            return index - 1;
+        }
+        if (to < from && index >= to && index < from)
+        {
+            return index + 1;
+        }
+        return index;
+    };
+    m_currentIndex = remap(m_currentIndex);
+    m_hoverIndex   = remap(m_hoverIndex);
+    m_pressIndex   = remap(m_pressIndex);
+    if (validIndex(m_hoverIndex))
+    {
+        m_hoverRect = tabRect(visibleIndex(m_hoverIndex));
+    }
+
+    // rows outside the moved range only shift when the row count changes,
+    // e.g. when the tab moved into or out of a collapsed group
+    if (firstVisibleIndex == -1 || lastVisibleIndex == -1 || rows().size() != rowCount)
+    {
+        update();
+    }
+    else
+    {
+        updateTabRange(firstVisibleIndex, lastVisibleIndex);
+    }
+    emit tabMoved(from, to);
+}
+
+void FancyTabBar::updateTabRange(int firstVisibleIndex, int lastVisibleIndex)
+{
+    // the range may wrap across columns, so its rows are united one by one
+    QRect area;
+    for (int row = firstVisibleIndex; row <= lastVisibleIndex; ++row)
+    {
+        area |= tabRect(row);
+    }
+    update(area);
+}
+
+void FancyTabBar::setTabToolTip(int index, const QString& toolTip)
+{
+    const FancyTab* tab = m_tabs.at(index);
+    if (toolTip.isEmpty())
+    {
+        m_toolTips.remove(tab);
+    }
+    else
+    {
+        m_toolTips.insert(tab, toolTip);
+    }
+}
+
+QString FancyTabBar::tabToolTip(int index) const
+{
+    const FancyTab* tab = m_tabs.at(index);
+    const auto fixed    = m_toolTips.constFind(tab);
+    if (fixed != m_toolTips.cend())
+    {
+        return fixed.value();
+    }
+    if (const QString* cached = m_toolTipCache.object(tab))
+    {
+        return *cached;
+    }
+    if (!m_toolTipProvider || m_pendingToolTips.contains(tab))
+    {
+        return {};
+    }
+
+    const QString toolTip = m_toolTipProvider(index);
+    if (!toolTip.isNull())
+    {
+        m_toolTipCache.insert(tab, new QString(toolTip));
+    }
+    return toolTip;
+}
+
+void FancyTabBar::setTabToolTipProvider(ToolTipProvider provider)
+{
+    m_toolTipProvider = std::move(provider);
+    m_toolTipCache.clear();
+    m_pendingToolTips.clear();
+}
+
+void FancyTabBar::provideTabToolTip(quint64 tabId, const QString& toolTip)
+{
+    // the tab may have been removed since, or moved to another index
+    const FancyTab* tab = m_tabsById.value(tabId);
+    if (!tab)
+    {
+        return;
+    }
+    m_pendingToolTips.remove(tab);
+    m_toolTipCache.insert(tab, new QString(toolTip));
+    if (tab->index == m_hoverIndex && underMouse() && !toolTip.isEmpty())
+    {
+        QToolTip::showText(QCursor::pos(), toolTip, this);
+    }
+}
+
+void FancyTabBar::invalidateTabToolTip(int index)
+{
+    if (validIndex(index))
+    {
+        m_toolTipCache.remove(m_tabs.at(index));
+        m_pendingToolTips.remove(m_tabs.at(index));
+    }
+}
+
+void FancyTabBar::setTabBadge(int index, const QString& badge, const QColor& color)
+{
+    if (!validIndex(index))
+    {
+        return;
+    }
+
+    FancyTab* tab          = m_tabs[ index ];
+    tab->pendingBadge      = badge;
+    tab->pendingBadgeColor = color;
+    if (!tab->badgePending)
+    {
+        tab->badgePending = true;
+        m_pendingBadges.append(tab);
+    }
+    scheduleFrame();
+}
+
+QRect FancyTabBar::badgeRect(const QRect& rect, const QString& badge, const QColor& color) const
+{
+    if (badge.isEmpty() && !color.isValid())
+    {
+        return {};
+    }
+
+    const int margin = 3;
+    if (badge.isEmpty())
+    {
+        const int dotSize = 8;
+        return { rect.right() - margin - dotSize + 1, rect.top() + margin, dotSize, dotSize };
+    }
+
+    const QFontMetrics fm(badgeFont());
+    const int height = fm.height();
+    const int width  = qMax(height, fm.horizontalAdvance(badge) + height / 2);
+    return { rect.right() - margin - width + 1, rect.top() + margin, width, height };
+}
+
+// Starts the frame timer; everything staged until it fires is applied at once.
+void FancyTabBar::scheduleFrame()
+{
+    if (m_frameTimer.isActive())
+    {
+        return;
+    }
+
+    const qreal refreshRate = screen() ? screen()->refreshRate() : 60.0;
+    m_frameTimer.start(qMax(1, qRound(1000.0 / (refreshRate > 0 ? refreshRate : 60.0))));
+}
+
+void FancyTabBar::flushPendingUpdates()
+{
+    applyQueuedUpdates();
+
+    QRegion damage;
+    for (FancyTab* tab : std::as_const(m_pendingBadges))
+    {
+        tab->badgePending = false;
+        if (tab->pendingBadge == tab->badge && tab->pendingBadgeColor == tab->badgeColor)
+        {
+            continue;
+        }
+        const int row = visibleIndex(tab->index);
+        if (row != -1)
+        {
+            // damage where the tab is drawn, which differs from its slot
+            // while it is dragged or slides into place
+            const QRect rect = m_dragging && tab->index == m_pressIndex
+                                   ? draggedTabRect()
+                                   : tabRect(row).translated(m_layout->flowOffset(qRound(tab->offset())));
+            // antialiased edges may bleed one pixel out of the badge rect
+            damage += badgeRect(rect, tab->badge, tab->badgeColor).adjusted(-1, -1, 1, 1);
+            damage += badgeRect(rect, tab->pendingBadge, tab->pendingBadgeColor).adjusted(-1, -1, 1, 1);
+        }
+        tab->badge      = tab->pendingBadge;
+        tab->badgeColor = tab->pendingBadgeColor;
+    }
+    m_pendingBadges.clear();
+
+    if (!damage.isEmpty())
+    {
+        update(damage);
+    }
+}
+
+void FancyTabBar::applyQueuedUpdates()
+{
+    FancyTabUpdateQueue::Update* updates = m_updateQueue.takeAll();
+    if (!updates)
+    {
+        return;
+    }
+
+    // the last update posted for a given tab and field wins
+    QHash<QPair<quint64, int>, const FancyTabUpdateQueue::Update*> latest;
+    for (auto update = updates; update; update = update->next)
+    {
+        latest.insert({ update->tabId, update->field }, update);
+    }
+
+    QRegion damage;
+    bool relayout = false;
+    for (const FancyTabUpdateQueue::Update* update : std::as_const(latest))
+    {
+        // the tab may have been removed since, or moved to another index
+        FancyTab* tab = m_tabsById.value(update->tabId);
+        if (!tab)
+        {
+            continue;
+        }
+
+        switch (update->field)
+        {
+        case FancyTabUpdateQueue::Enabled:
+            if (tab->enabled != update->flag)
+            {
+                tab->enabled = update->flag;
+                if (tab->visible)
+                {
+                    damage += tabRect(visibleIndex(tab->index));
+                }
+            }
+            break;
+        case FancyTabUpdateQueue::Visible:
+            if (tab->visible != update->flag)
+            {
+                tab->visible = update->flag;
+                relayout     = true;
+            }
+            break;
+        case FancyTabUpdateQueue::ToolTip:
+            setTabToolTip(tab->index, update->text);
+            break;
+        case FancyTabUpdateQueue::Badge:
+            tab->pendingBadge      = update->text;
+            tab->pendingBadgeColor = update->color;
+            if (!tab->badgePending)
+            {
+                tab->badgePending = true;
+                m_pendingBadges.append(tab);
+            }
+            break;
+        case FancyTabUpdateQueue::Text:
+            if (tab->text != update->text)
+            {
+                tab->text = update->text;
+                m_labelIndex.update(tab, tab->text);
+                relayout = true;
+            }
+            break;
+        }
+    }
+
+    while (updates)
+    {
+        delete std::exchange(updates, updates->next);
+    }
+
+    if (relayout)
+    {
+        invalidateTabSizeHint();
+        updateGeometry();
+        update();
+    }
+    else if (!damage.isEmpty())
+    {
+        update(damage);
+    }
+}
+
+// Renders the icons for every connected screen's device pixel ratio ahead of
+// time, a few tabs per event loop pass, so moving the window to another
+// screen finds them in the cache instead of rasterizing mid-drag.
+void FancyTabBar::scheduleRenderCacheWarmUp()
+{
+    m_warmUpIndex = 0;
+    m_warmUpTimer.start();
+}
+
+void FancyTabBar::warmUpRenderCache()
+{
+    const QSize iconSize(Core::Constants::MODEBAR_ICON_SIZE, Core::Constants::MODEBAR_ICON_SIZE);
+    const int tabsPerPass     = 8;
+    const QList<qreal> ratios = screenDevicePixelRatios();
+    const QColor iconColor    = getFancyTabBarIconColor();
+    // leave the rest of the budget to what is actually painted, otherwise
+    // warming up would evict the icons on screen
+    const qsizetype byteLimit = m_renderCache->budget() / 2;
+    const int end             = qMin(m_warmUpIndex + tabsPerPass, int(m_tabs.count()));
+    for (; m_warmUpIndex < end; ++m_warmUpIndex)
+    {
+        if (m_renderCache->statistics().bytes >= byteLimit)
+        {
+            m_warmUpTimer.stop();
+            return;
+        }
+
+        // hidden and collapsed tabs are not painted, the current one is the
+        // only one painted active
+        const FancyTab* tab = m_tabs.at(m_warmUpIndex);
+        if (visibleIndex(m_warmUpIndex) == -1)
+        {
+            continue;
+        }
+        const bool selected      = m_warmUpIndex == m_currentIndex;
+        const QIcon::Mode mode   = tab->enabled ? (selected ? QIcon::Active : QIcon::Normal) : QIcon::Disabled;
+        const QIcon::State state = selected ? QIcon::On : QIcon::Off;
+        for (const qreal ratio : ratios)
+        {
+            tintedIconPixmap(m_renderCache.get(), tab->icon, iconSize, ratio, mode, state, iconColor);
+        }
+    }
+    if (m_warmUpIndex >= m_tabs.count())
+    {
+        m_warmUpTimer.stop();
+    }
+}
+
+void FancyTabBar::setTabText(int index, const QString& text)
+{
+    Q_ASSERT(validIndex(index));
+
+    if (validIndex(index) && m_tabs[ index ]->text != text)
+    {
+        m_tabs[ index ]->text = text;
+        m_labelIndex.update(m_tabs[ index ], text);
+        invalidateTabSizeHint();
+        updateGeometry();
+        update();
+    }
+}
+
+QList<int> FancyTabBar::findTabs(const QString& query, int limit) const
+{
+    const QList<const FancyTab*> tabs = m_labelIndex.match(query,
+                                                           limit,
+                                                           [](const FancyTab* tab)
+                                                           { return tab->visible && tab->enabled; });
+    QList<int> indices;
+    indices.reserve(tabs.size());
+    for (const FancyTab* tab : tabs)
+    {
+        indices.append(tab->index);
+    }
+    return indices;
+}
+
+void FancyTabBar::setIconsOnly(bool iconsOnly)
+{
+    m_iconsOnly = iconsOnly;
+    updateTabLayout();
+}
+
+void FancyTabBar::setArrangement(Arrangement arrangement)
+{
+    if (arrangement == m_arrangement)
+    {
+        return;
+    }
+    m_arrangement = arrangement;
+    if (m_arrangement == HorizontalArrangement)
+    {
+        setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Minimum);
+    }
+    else
+    {
+        setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Expanding);
+    }
+    updateTabLayout();
+}
+
+void FancyTabBar::setRowSizing(RowSizing sizing)
+{
+    if (sizing == m_rowSizing)
+    {
+        return;
+    }
+    m_rowSizing = sizing;
+    updateTabLayout();
+}
+
+void FancyTabBar::updateTabLayout()
+{
+    m_layout = makeTabLayout(m_arrangement, m_iconsOnly, m_rowSizing);
+    invalidateTabSizeHint();
+    updateGeometry();
+    update();
+}
+
+void FancyTabBar::insertTab(int index, const QIcon& icon, const QString& label, bool hasMenu)
+{
+    auto tab     = new FancyTab(this);
+    tab->icon    = icon;
+    tab->text    = label;
+    tab->hasMenu = hasMenu;
+    tab->enabled = true;
+    tab->id      = m_nextTabId++;
+    m_tabs.insert(index, tab);
+    m_tabsById.insert(tab->id, tab);
+    renumberTabs(index, int(m_tabs.count()) - 1);
+    m_labelIndex.insert(tab, label);
+    // every stored index at or after the new tab shifts with it
+    for (int* stored : { &m_currentIndex, &m_hoverIndex, &m_pressIndex })
+    {
+        if (*stored >= index)
+        {
+            ++*stored;
+        }
+    }
+    adjustGroupsForInsert(index);
+    invalidateTabSizeHint();
+    if (validIndex(m_hoverIndex))
+    {
+        m_hoverRect = tabRect(visibleIndex(m_hoverIndex));
+    }
+    updateGeometry();
+    update();
+    scheduleRenderCacheWarmUp();
+}
+
+void FancyTabBar::renumberTabs(int first, int last)
+{
+    for (int i = first; i <= last; ++i)
+    {
+        m_tabs.at(i)->index = i;
+    }
+}
+
+void FancyTabBar::adjustGroupsForInsert(int index)
+{
+    for (FancyTabGroup& group : m_groups)
+    {
+        if (index <= group.first)
+        {
+            ++group.first;
+        }
+        else if (index < group.first + group.count)
+        {
+            ++group.count;
+        }
     }
 }
 
-static void paintHighlight(QPainter* painter, const QRect& rect, const QColor& color)
+void FancyTabBar::adjustGroupsForRemove(int index)
 {
-    QRect accentRect = rect;
-    accentRect.setWidth(2);
-    painter->fillRect(accentRect, color);
+    for (FancyTabGroup& group : m_groups)
+    {
+        if (index < group.first)
+        {
+            --group.first;
+        }
+        else if (index < group.first + group.count)
+        {
+            --group.count;
+        }
+    }
 }
 
-static void paintIcon(QPainter* painter,
-                      const QRect& rect,
-                      const QIcon& icon,
-                      QIcon::State iconState,
-                      bool enabled,
-                      bool selected,
-                      QColor c)
+int FancyTabBar::addTabGroup(const QString& name, int first, int count)
 {
-    painter->save();
-    const QIcon::Mode iconMode = enabled ? (selected ? QIcon::Active : QIcon::Normal) : QIcon::Disabled;
-    QRect iconRect(0, 0, Core::Constants::MODEBAR_ICON_SIZE, Core::Constants::MODEBAR_ICON_SIZE);
-    iconRect.moveCenter(rect.center());
-    iconRect = iconRect.intersected(rect);
-
-    if (!enabled)
-    {
-        painter->setOpacity(0.7);
-    }
+    Q_ASSERT(first >= 0 && count >= 0 && first + count <= m_tabs.count());
 
-    QPixmap pixmap = icon.pixmap(iconRect.size(), iconMode, iconState);
-    pixmap         = setPixmapColor(pixmap, c);
-    painter->drawPixmap(iconRect, pixmap);
+    const auto next = std::find_if(m_groups.begin(),
+                                   m_groups.end(),
+                                   [ first ](const FancyTabGroup& group) { return group.first >= first; });
+    Q_ASSERT(next == m_groups.begin() || std::prev(next)->first + std::prev(next)->count <= first);
+    Q_ASSERT(next == m_groups.end() || next->first >= first + count);
 
-    painter->restore();
+    const int group = int(next - m_groups.begin());
+    m_groups.insert(group, { name, first, count, false });
+    invalidateLayout();
+    updateGeometry();
+    update();
+    return group;
 }
 
-void FancyTabBar::paintIconAndText(QPainter* painter,
-                                   const QRect& rect,
-                                   const QIcon& icon,
-                                   QIcon::State iconState,
-                                   const QString& text,
-                                   bool enabled,
-                                   bool selected) const
+void FancyTabBar::removeTabGroup(int group)
 {
-    painter->save();
-    QFont boldFont = qApp->font();
-    boldFont.setPointSize(8);
-    boldFont.setBold(true);
-    painter->setFont(boldFont);
+    m_groups.removeAt(group);
+    invalidateLayout();
+    updateGeometry();
+    update();
+}
 
-    const bool drawIcon = rect.height() > 36;
-    if (drawIcon)
+int FancyTabBar::tabGroup(int index) const
+{
+    for (int group = 0; group < m_groups.count(); ++group)
     {
-        const int textHeight = painter->fontMetrics().boundingRect(rect, Qt::TextWordWrap, text).height();
-        const QRect tabIconRect(rect.adjusted(0, 4, 0, -textHeight));
-        const QIcon::Mode iconMode = enabled ? (selected ? QIcon::Active : QIcon::Normal) : QIcon::Disabled;
-        QRect iconRect(0, 0, Core::Constants::MODEBAR_ICON_SIZE, Core::Constants::MODEBAR_ICON_SIZE);
-        iconRect.moveCenter(tabIconRect.center());
-        iconRect = iconRect.intersected(tabIconRect);
-        if (!enabled)
+        const FancyTabGroup& entry = m_groups.at(group);
+        if (index >= entry.first && index < entry.first + entry.count)
         {
-            painter->setOpacity(0.7);
+            return group;
         }
-
-        QPixmap pixmap = icon.pixmap(iconRect.size(), iconMode, iconState);
-        pixmap         = setPixmapColor(pixmap, getFancyTabBarIconColor());
-        painter->drawPixmap(iconRect, pixmap);
-    }
-
-    painter->setOpacity(1.0);  // FIXME: was 0.7 before?
-    if (enabled)
-    {
-        painter->setPen(selected ? getFancyTabWidgetEnabledSelectedTextColor()
-                                 : getFancyTabWidgetEnabledUnselectedTextColor());
     }
-    else
-    {
-        painter->setPen(selected ? getFancyTabWidgetDisabledSelectedTextColor()
-                                 : getFancyTabWidgetDisabledUnselectedTextColor());
-    }
-
-    painter->translate(0, -1);
-    QRect tabTextRect(rect);
-    tabTextRect.translate(0, drawIcon ? -2 : 1);
-    const int textFlags = Qt::AlignCenter | (drawIcon ? Qt::AlignBottom : Qt::AlignVCenter) | Qt::TextWordWrap;
-    painter->drawText(tabTextRect, textFlags, text);
-    painter->restore();
+    return -1;
 }
 
-void FancyTabBar::paintTab(QPainter* painter, int tabIndex, int visibleIndex, QIcon::State iconState) const
+void FancyTabBar::setTabGroupCollapsed(int group, bool collapsed)
 {
-    if (!validIndex(tabIndex))
+    FancyTabGroup& entry = m_groups[ group ];
+    if (entry.collapsed == collapsed)
     {
-        qWarning("invalid index");
         return;
     }
-    painter->save();
 
-    const FancyTab* tab = m_tabs.at(tabIndex);
-    const QRect rect    = tabRect(visibleIndex);
-    const bool selected = (tabIndex == m_currentIndex);
-    const bool enabled  = isTabEnabled(tabIndex);
+    const int header = m_rowsValid ? headerRow(group) : -1;
+    entry.collapsed  = collapsed;
 
-    if (selected)
+    if (collapsed && m_hoverIndex >= entry.first && m_hoverIndex < entry.first + entry.count)
     {
-        painter->fillRect(rect, getFancyTabBarSelectedBackgroundColor());
+        m_tabs[ m_hoverIndex ]->fadeOut();
+        m_hoverIndex = -1;
+        m_hoverRect  = QRect();
     }
 
-    const qreal fader = tab->fader();
-    if (fader > 0 && !selected && enabled)
+    int sectionRows = 0;
+    for (int i = entry.first; i < entry.first + entry.count; ++i)
     {
-        painter->save();
-        painter->setOpacity(fader);
-        painter->fillRect(rect, getFancyToolButtonHoverColor());
-        painter->restore();
+        if (m_tabs.at(i)->visible)
+        {
+            ++sectionRows;
+        }
     }
 
-    if (m_iconsOnly)
-    {
-        paintIcon(painter, rect, tab->icon, iconState, enabled, selected, getFancyTabBarIconColor());
-    }
-    else
+    // As long as no row has to shrink, only the group's own rows change and
+    // the rows below it move by the section height; everything else keeps
+    // its layout.
+    const int tabHeight   = tabSizeHint().height();
+    const int tabRows     = m_layoutTabRows + (collapsed ? -sectionRows : sectionRows);
+    const int headerSpace = groupHeaderHeight() * m_layoutHeaderRows;
+    const bool fitted     = tabHeight * m_layoutTabRows + headerSpace <= height();
+    const bool fits       = tabHeight * tabRows + headerSpace <= height();
+    if (header != -1 && m_layout->stacksUniformRows() && fitted && fits)
     {
-        paintIconAndText(painter, rect, tab->icon, iconState, tab->text, enabled, selected);
-    }
+        const int top   = m_rows.at(header).rect.bottom() + 1;
+        const int delta = (collapsed ? -sectionRows : sectionRows) * tabHeight;
 
-    if (selected)
-    {
-        paintHighlight(painter, rect, getFancyToolButtonHighlightColor());
-    }
+        QList<Row> section;
+        if (!collapsed)
+        {
+            section.reserve(sectionRows);
+            int y = top;
+            for (int i = entry.first; i < entry.first + entry.count; ++i)
+            {
+                if (m_tabs.at(i)->visible)
+                {
+                    section.append({ i, false, QRect(0, y, m_rows.at(header).rect.width(), tabHeight) });
+                    y += tabHeight;
+                }
+            }
+        }
 
-    // menu arrow
-    if (tab->hasMenu && !m_iconsOnly)
-    {
-        QStyleOption opt;
-        opt.initFrom(this);
-        opt.rect = rect.adjusted(rect.width() - kMenuButtonWidth, 0, -8, 0);
-        drawArrow(QStyle::PE_IndicatorArrowRight,
-                  painter,
-                  &opt,
-                  getFancyTabWidgetDisabledSelectedTextColor(),
-                  getFancyTabBarIconColor());
+        const qsizetype tail = header + 1 + (collapsed ? sectionRows : 0);
+        QList<Row> laidOut   = m_rows.mid(0, header + 1);
+        laidOut.reserve(m_rows.size() + section.size());
+        laidOut.append(section);
+        for (qsizetype i = tail; i < m_rows.size(); ++i)
+        {
+            laidOut.append(m_rows.at(i));
+            laidOut.last().rect.translate(0, delta);
+        }
+        m_rows          = laidOut;
+        m_layoutTabRows = tabRows;
+        update(QRect(0, m_rows.at(header).rect.top(), width(), height()));
     }
-    painter->restore();
-}
-
-void FancyTabBar::setCurrentIndex(int index)
-{
-    if ((index == -1 || isTabEnabled(index)) && index != m_currentIndex)
+    else
     {
-        emit currentAboutToChange(index);
-        m_currentIndex = index;
+        invalidateLayout();
         update();
-        emit currentChanged(m_currentIndex);
     }
-}
-
-void FancyTabBar::setIconsOnly(bool iconsOnly)
-{
-    m_iconsOnly = iconsOnly;
     updateGeometry();
+    emit tabGroupCollapsedChanged(group, collapsed);
 }
 
 void FancyTabBar::setTabEnabled(int index, bool enable)
@@ -570,6 +2470,8 @@ void FancyTabBar::setTabVisible(int index, bool visible)
     Q_ASSERT(index >= 0);
 
     m_tabs[ index ]->visible = visible;
+    invalidateLayout();
+    updateGeometry();
     update();
 }
 
@@ -601,6 +2503,106 @@ signals:
     void clicked(QMouseEvent* ev);
 };
 
+class FancyTabQuickSwitcher : public QFrame
+{
+    Q_OBJECT
+
+public:
+    FancyTabQuickSwitcher(FancyTabBar* tabBar, QWidget* parent)
+        : QFrame(parent, Qt::Popup)
+        , m_tabBar(tabBar)
+    {
+        setFrameShape(QFrame::StyledPanel);
+
+        m_edit = new QLineEdit(this);
+        m_edit->setPlaceholderText(QStringLiteral("Go to mode..."));
+        m_edit->installEventFilter(this);
+        m_list = new QListWidget(this);
+        m_list->setFocusPolicy(Qt::NoFocus);
+
+        QVBoxLayout* layout = new QVBoxLayout(this);
+        layout->setContentsMargins(4, 4, 4, 4);
+        layout->setSpacing(4);
+        layout->addWidget(m_edit);
+        layout->addWidget(m_list);
+
+        connect(m_edit, &QLineEdit::textChanged, this, &FancyTabQuickSwitcher::search);
+        connect(m_list, &QListWidget::itemActivated, this, &FancyTabQuickSwitcher::choose);
+    }
+
+    void popup(const QRect& anchor)
+    {
+        m_edit->clear();
+        m_list->clear();
+        resize(qMin(anchor.width(), 400), 300);
+        move(anchor.center().x() - width() / 2, anchor.top() + anchor.height() / 6);
+        show();
+        m_edit->setFocus();
+    }
+
+signals:
+    void tabChosen(int index);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override
+    {
+        if (watched == m_edit && event->type() == QEvent::KeyPress)
+        {
+            const auto keyEvent = static_cast<QKeyEvent*>(event);
+            switch (keyEvent->key())
+            {
+            case Qt::Key_Up:
+            case Qt::Key_Down:
+            case Qt::Key_PageUp:
+            case Qt::Key_PageDown:
+                QApplication::sendEvent(m_list, event);
+                return true;
+            case Qt::Key_Return:
+            case Qt::Key_Enter:
+                choose(m_list->currentItem());
+                return true;
+            default:
+                break;
+            }
+        }
+        return QFrame::eventFilter(watched, event);
+    }
+
+private:
+    void search(const QString& text)
+    {
+        m_list->clear();
+        const QList<int> indices = m_tabBar->findTabs(text);
+        for (const int index : indices)
+        {
+            auto item = new QListWidgetItem(m_tabBar->tabIcon(index), m_tabBar->tabText(index), m_list);
+            // tabs may move or go away while the popup is open
+            item->setData(Qt::UserRole, m_tabBar->tabId(index));
+        }
+        m_list->setCurrentRow(0);
+    }
+
+    void choose(QListWidgetItem* item)
+    {
+        if (!item)
+        {
+            return;
+        }
+        const int index = m_tabBar->tabIndex(item->data(Qt::UserRole).toULongLong());
+        if (index == -1)
+        {
+            delete item;
+            return;
+        }
+        hide();
+        emit tabChosen(index);
+    }
+
+    FancyTabBar* m_tabBar;
+    QLineEdit* m_edit;
+    QListWidget* m_list;
+};
+
 #if 1
 //////
 // FancyTabWidget
@@ -622,20 +2624,47 @@ FancyTabWidget::FancyTabWidget(QWidget* parent)
     connect(m_tabBar, &FancyTabBar::currentAboutToChange, this, &FancyTabWidget::currentAboutToShow);
     connect(m_tabBar, &FancyTabBar::currentChanged, this, &FancyTabWidget::showWidget);
     connect(m_tabBar, &FancyTabBar::menuTriggered, this, &FancyTabWidget::menuTriggered);
+    connect(m_tabBar, &FancyTabBar::tabMoved, this, [ this ](int from, int to) { m_pages.move(from, to); });
+    connect(m_tabBar, &FancyTabBar::tabHoverSettled, this, &FancyTabWidget::prepareHoveredPage);
+    connect(m_tabBar, &FancyTabBar::tabToolTipRequested, this, &FancyTabWidget::tabToolTipRequested);
 }
 
 void FancyTabWidget::insertTab(int index, QWidget* tab, const QIcon& icon, const QString& label, bool hasMenu)
 {
-    m_modesStack->insertWidget(index, tab);
+    m_modesStack->addWidget(tab);
+    m_pages.insert(index, tab);
     m_tabBar->insertTab(index, icon, label, hasMenu);
 }
 
 void FancyTabWidget::removeTab(int index)
 {
-    m_modesStack->removeWidget(m_modesStack->widget(index));
+    QWidget* page = m_pages.takeAt(index);
+    m_preparedPages.remove(page);
+    m_pageFrames.remove(page);
+    if (m_pendingPage == page)
+    {
+        m_pendingPage = nullptr;
+    }
+    // otherwise the stack would raise an arbitrary page until the tab bar
+    // reports the new current tab
+    if (m_modesStack->currentWidget() == page)
+    {
+        showPlaceholder(QPixmap());
+    }
+    m_modesStack->removeWidget(page);
     m_tabBar->removeTab(index);
 }
 
+void FancyTabWidget::moveTab(int from, int to)
+{
+    m_tabBar->moveTab(from, to);
+}
+
+void FancyTabWidget::setTabsMovable(bool movable)
+{
+    m_tabBar->setTabsMovable(movable);
+}
+
 void FancyTabWidget::setBackgroundBrush(const QBrush& brush)
 {
     QPalette pal;
@@ -653,9 +2682,51 @@ void FancyTabWidget::setCurrentIndex(int index)
     m_tabBar->setCurrentIndex(index);
 }
 
+void FancyTabWidget::showQuickSwitcher()
+{
+    if (!m_quickSwitcher)
+    {
+        m_quickSwitcher = new FancyTabQuickSwitcher(m_tabBar, this);
+        connect(m_quickSwitcher, &FancyTabQuickSwitcher::tabChosen, this, &FancyTabWidget::setCurrentIndex);
+    }
+    m_quickSwitcher->popup(QRect(mapToGlobal(QPoint(0, 0)), size()));
+}
+
 void FancyTabWidget::showWidget(int index)
 {
-    m_modesStack->setCurrentIndex(index);
+    QWidget* page = m_pages.value(index);
+    if (m_preparedSwitch && page && (!m_preparedPages.contains(page) || m_pageFrames.contains(page)))
+    {
+        // keep the click cheap: show the cached frame, if any, and swap in
+        // the real page once it has been prepared
+        if (const QPixmap* frame = m_pageFrames.object(page))
+        {
+            showPlaceholder(*frame);
+        }
+        m_pendingPage = page;
+        QTimer::singleShot(0, this, &FancyTabWidget::finishPendingSwitch);
+        return;
+    }
+    activatePage(index);
+}
+
+void FancyTabWidget::activatePage(int index)
+{
+    if (QWidget* page = m_pages.value(index))
+    {
+        m_modesStack->setCurrentWidget(page);
+        m_preparedPages.insert(page);
+        m_pageFrames.remove(page);
+        if (m_placeholder)
+        {
+            m_placeholder->clear();
+        }
+    }
+    else
+    {
+        // no tab is current, so no page may show either
+        showPlaceholder(QPixmap());
+    }
     QWidget* w = m_modesStack->currentWidget();
     if (w)
     {
@@ -668,11 +2739,125 @@ void FancyTabWidget::showWidget(int index)
     emit currentChanged(index);
 }
 
+void FancyTabWidget::showPlaceholder(const QPixmap& frame)
+{
+    if (!m_placeholder)
+    {
+        m_placeholder = new QLabel;
+        m_placeholder->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+        // a label reports its pixmap as minimum size, which would keep the
+        // widget from shrinking below the size of the last frame
+        m_placeholder->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
+        m_modesStack->addWidget(m_placeholder);
+    }
+    m_placeholder->setPixmap(frame);
+    m_modesStack->setCurrentWidget(m_placeholder);
+}
+
+void FancyTabWidget::finishPendingSwitch()
+{
+    QWidget* page = m_pendingPage;
+    m_pendingPage = nullptr;
+    // a later switch may have superseded this one
+    const int index = int(m_pages.indexOf(page));
+    if (!page || index != currentIndex())
+    {
+        return;
+    }
+    if (!m_preparedPages.contains(page))
+    {
+        // polish and lay out in this pass, swap in and paint in the next, so
+        // the event loop is never blocked for both at once
+        preparePage(page);
+        m_pendingPage = page;
+        QTimer::singleShot(0, this, &FancyTabWidget::finishPendingSwitch);
+        return;
+    }
+    activatePage(index);
+}
+
+void FancyTabWidget::preparePage(QWidget* page)
+{
+    if (m_preparedPages.contains(page))
+    {
+        return;
+    }
+    page->ensurePolished();
+    page->resize(m_modesStack->geometry().size());
+    if (QLayout* layout = page->layout())
+    {
+        layout->activate();
+    }
+    m_preparedPages.insert(page);
+}
+
+void FancyTabWidget::prepareHoveredPage(int index)
+{
+    QWidget* page = m_pages.value(index);
+    if (!m_preparedSwitch || !page || index == currentIndex() || m_pageFrames.contains(page))
+    {
+        return;
+    }
+    const bool firstShow = !m_preparedPages.contains(page);
+    preparePage(page);
+    if (firstShow)
+    {
+        // a byte budget keeps hovering along a long bar from piling up
+        // window sized pixmaps
+        const QPixmap frame = page->grab();
+        m_pageFrames.insert(page, new QPixmap(frame), qsizetype(frame.width()) * frame.height() * frame.depth() / 8);
+    }
+}
+
+void FancyTabWidget::setPreparedSwitchEnabled(bool enabled)
+{
+    m_preparedSwitch = enabled;
+    if (!enabled)
+    {
+        m_pageFrames.clear();
+    }
+}
+
 void FancyTabWidget::setTabToolTip(int index, const QString& toolTip)
 {
     m_tabBar->setTabToolTip(index, toolTip);
 }
 
+void FancyTabWidget::setTabToolTipProvider(FancyTabBar::ToolTipProvider provider)
+{
+    m_tabBar->setTabToolTipProvider(std::move(provider));
+}
+
+void FancyTabWidget::provideTabToolTip(quint64 tabId, const QString& toolTip)
+{
+    m_tabBar->provideTabToolTip(tabId, toolTip);
+}
+
+void FancyTabWidget::invalidateTabToolTip(int index)
+{
+    m_tabBar->invalidateTabToolTip(index);
+}
+
+void FancyTabWidget::setTabBadge(int index, const QString& badge, const QColor& color)
+{
+    m_tabBar->setTabBadge(index, badge, color);
+}
+
+void FancyTabWidget::setTabText(int index, const QString& text)
+{
+    m_tabBar->setTabText(index, text);
+}
+
+FancyTabUpdateQueue* FancyTabWidget::updateQueue() const
+{
+    return m_tabBar->updateQueue();
+}
+
+quint64 FancyTabWidget::tabId(int index) const
+{
+    return m_tabBar->tabId(index);
+}
+
 void FancyTabWidget::setTabEnabled(int index, bool enable)
 {
     m_tabBar->setTabEnabled(index, enable);
@@ -692,6 +2877,34 @@ void FancyTabWidget::setIconsOnly(bool iconsOnly)
 {
     m_tabBar->setIconsOnly(iconsOnly);
 }
+
+void FancyTabWidget::setRenderProfile(FancyTabBar::RenderProfile profile)
+{
+    m_tabBar->setRenderProfile(profile);
+}
+
+void FancyTabWidget::setTabBarArrangement(FancyTabBar::Arrangement arrangement)
+{
+    m_tabBar->setArrangement(arrangement);
+    static_cast<QBoxLayout*>(layout())->setDirection(arrangement == FancyTabBar::HorizontalArrangement
+                                                          ? QBoxLayout::TopToBottom
+                                                          : QBoxLayout::LeftToRight);
+}
+
+void FancyTabWidget::setTabRowSizing(FancyTabBar::RowSizing sizing)
+{
+    m_tabBar->setRowSizing(sizing);
+}
+
+int FancyTabWidget::addTabGroup(const QString& name, int first, int count)
+{
+    return m_tabBar->addTabGroup(name, first, count);
+}
+
+void FancyTabWidget::setTabGroupCollapsed(int group, bool collapsed)
+{
+    m_tabBar->setTabGroupCollapsed(group, collapsed);
+}
 #endif
 
 #include "fancytabwidget.moc"
@@ -3,10 +3,19 @@
 
 #pragma once
 
+#include <QCache>
 #include <QIcon>
+#include <QPointer>
 #include <QPropertyAnimation>
+#include <QSet>
+#include <QTimer>
 #include <QWidget>
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+
 #define QPROPERTY_CREATE(TYPE, MEM, VALUE)               \
     Q_PROPERTY(TYPE MEM READ get##MEM WRITE set##MEM) \
                                                          \
@@ -28,16 +37,80 @@ private:                                                 \
     TYPE p##MEM { VALUE };
 
 QT_BEGIN_NAMESPACE
+class QLabel;
 class QPainter;
 class QStackedLayout;
 class QStatusBar;
 QT_END_NAMESPACE
 
+// Process-wide cache of rasterized tab artwork (tinted icons, menu arrows)
+// shared by every FancyTabBar. Entries are keyed by content rather than by
+// owner, so the same modes in several windows are rendered only once. The
+// cache lives as long as at least one bar holds a reference to it.
+class FancyRenderCache
+{
+public:
+    struct Key
+    {
+        qint64 source;  // QIcon::cacheKey(), 0 for built-in primitives
+        QRgb tint;
+        QSize size;
+        qreal devicePixelRatio;
+        int variant;  // icon mode and state, or primitive element
+
+        bool operator==(const Key& other) const
+        {
+            return source == other.source && tint == other.tint && size == other.size
+                && devicePixelRatio == other.devicePixelRatio && variant == other.variant;
+        }
+    };
+
+    struct Statistics
+    {
+        qint64 hits;
+        qint64 misses;
+        qsizetype entries;
+        qsizetype bytes;
+        qsizetype budget;
+    };
+
+    FancyRenderCache();
+    ~FancyRenderCache();
+
+    FancyRenderCache(const FancyRenderCache&)            = delete;
+    FancyRenderCache& operator=(const FancyRenderCache&) = delete;
+
+    static std::shared_ptr<FancyRenderCache> instance();
+
+    QPixmap find(const Key& key);
+    void insert(const Key& key, const QPixmap& pixmap);
+    void clear();
+
+    // Drops every entry rendered for a device pixel ratio not in ratios.
+    void retainDevicePixelRatios(const QList<qreal>& ratios);
+
+    // Memory budget in bytes for all cached pixmaps together.
+    void setBudget(qsizetype bytes) { m_pixmaps.setMaxCost(bytes); }
+
+    qsizetype budget() const { return m_pixmaps.maxCost(); }
+
+    Statistics statistics() const;
+
+private:
+    QCache<Key, QPixmap> m_pixmaps;
+    QMetaObject::Connection m_screenRemovedConnection;
+    qint64 m_hits   = 0;
+    qint64 m_misses = 0;
+};
+
+size_t qHash(const FancyRenderCache::Key& key, size_t seed = 0);
+
 class FancyTab : public QObject
 {
     Q_OBJECT
 
     Q_PROPERTY(qreal fader READ fader WRITE setFader)
+    Q_PROPERTY(qreal offset READ offset WRITE setOffset)
 
 public:
     FancyTab(QWidget* parentTabBar)
@@ -55,23 +128,219 @@ public:
     void fadeIn();
     void fadeOut();
 
+    // Displacement along the bar from the laid out position, animated back
+    // to 0 while tabs are reordered by dragging.
+    qreal offset() const { return m_offset; }
+
+    void setOffset(qreal offset);
+    void slideFrom(qreal offset);
+
     QIcon icon;
     QString text;
-    QString toolTip;
     bool enabled = false;
     bool visible = true;
     bool hasMenu = false;
+    int index    = -1;  // position in the bar, kept current by FancyTabBar
+    quint64 id   = 0;   // stable handle, see FancyTabBar::tabId()
+
+    // Counter or status dot drawn in the top right corner. Updates are
+    // staged in the pending fields and applied once per frame by the bar.
+    QString badge;
+    QColor badgeColor;
+    QString pendingBadge;
+    QColor pendingBadgeColor;
+    bool badgePending = false;
 
 private:
+    bool animated() const;
+
     QPropertyAnimation m_animator;
+    // only tabs that were slid by a drag pay for an animation object
+    std::unique_ptr<QPropertyAnimation> m_slideAnimator;
     QWidget* m_tabbar;
-    qreal m_fader = 0;
+    qreal m_fader  = 0;
+    qreal m_offset = 0;
+};
+
+// Incrementally maintained index over tab labels backing the quick switcher.
+// Labels are indexed by trigram and by the one and two character prefixes of
+// each word, so a query only scores the tabs sharing grams with it. Tabs are
+// identified by their FancyTab object, so reordering leaves the index valid.
+class FancyTabIndex
+{
+public:
+    void insert(const FancyTab* tab, const QString& label);
+    void remove(const FancyTab* tab);
+
+    void update(const FancyTab* tab, const QString& label)
+    {
+        remove(tab);
+        insert(tab, label);
+    }
+
+    // Returns up to limit accepted tabs matching query, best match first.
+    QList<const FancyTab*> match(const QString& query,
+                                 int limit,
+                                 const std::function<bool(const FancyTab*)>& accept) const;
+
+private:
+    QHash<const FancyTab*, QString> m_labels;
+    QHash<quint64, QSet<const FancyTab*>> m_postings;
+};
+
+// A named run of consecutive tabs drawn under a collapsible header.
+struct FancyTabGroup
+{
+    QString name;
+    int first      = 0;
+    int count      = 0;
+    bool collapsed = false;
+};
+
+// A laid out row of a FancyTabBar, either a tab or a group header.
+struct FancyTabRow
+{
+    int index;  // tab index, or group number for a header
+    bool header;
+    QRect rect;
+};
+
+class FancyTabBar;
+
+// Geometry and tab painting for one FancyTabBar configuration. The concrete
+// layouts are specializations of FancyTabLayoutPolicy in fancytabwidget.cpp,
+// one per flow, content and row sizing, so the per-row code carries no
+// configuration checks. The bar swaps the instance when its configuration
+// changes.
+class FancyTabLayout
+{
+public:
+    virtual ~FancyTabLayout() = default;
+
+    // Names the specialization, e.g. "horizontal/text/measured".
+    virtual const char* name() const = 0;
+
+    // Default tab size; the minimum one gives up extent along the flow.
+    virtual QSize tabSizeHint(const QList<FancyTab*>& tabs, bool minimum) const = 0;
+
+    // Places the rows for a bar of barSize, shrinking or wrapping them when
+    // they do not fit.
+    virtual void placeRows(QList<FancyTabRow>& rows,
+                           const QList<FancyTab*>& tabs,
+                           const QList<FancyTabGroup>& groups,
+                           const QSize& tabSize,
+                           const QSize& barSize) const = 0;
+
+    // Bar size needed to show the rows without shrinking them.
+    virtual QSize contentSize(const QList<FancyTabRow>& rows,
+                              const QList<FancyTab*>& tabs,
+                              const QList<FancyTabGroup>& groups,
+                              const QSize& tabSize,
+                              const QSize& barSize,
+                              bool minimum) const = 0;
+
+    // Lookups in rows placed by this layout.
+    virtual int rowAt(const QList<FancyTabRow>& rows, const QPoint& pos) const = 0;
+    virtual std::pair<int, int> rowRange(const QList<FancyTabRow>& rows, const QRect& area) const = 0;
+
+    // True when tab rows are stacked in a single column at the height of
+    // the size hint until they have to shrink.
+    virtual bool stacksUniformRows() const = 0;
+
+    // Coordinates along the flow, in which tabs are dragged.
+    virtual int flowPosition(const QPoint& pos) const = 0;
+    virtual int flowExtent(const QRect& rect) const = 0;
+    virtual QPoint flowOffset(int distance) const = 0;
+
+    // Paints the tab's content, selection accent and menu arrow.
+    virtual void paintTab(const FancyTabBar* bar,
+                          QPainter* painter,
+                          const QRect& rect,
+                          const FancyTab* tab,
+                          QIcon::State iconState,
+                          bool enabled,
+                          bool selected) const = 0;
+
+    // Paints a group header row: the collapse arrow and, with text, the name.
+    virtual void paintHeader(const FancyTabBar* bar,
+                             QPainter* painter,
+                             const QRect& rect,
+                             const FancyTabGroup& group) const = 0;
+
+    virtual bool hitsMenuButton(const QRect& rect, const QPoint& pos) const = 0;
+};
+
+// Lock-free multi-producer queue of tab state changes. Any thread may post;
+// the owning FancyTabBar takes the whole batch once per frame on the GUI
+// thread, collapses repeated changes to the same tab and applies them with a
+// single relayout and repaint. Tabs are addressed by FancyTabBar::tabId(), so
+// updates follow a tab that is moved before they are drained and are dropped
+// for a removed one. Posting must stop before the bar is destroyed.
+class FancyTabUpdateQueue
+{
+public:
+    enum Field
+    {
+        Enabled,
+        Visible,
+        ToolTip,
+        Badge,
+        Text
+    };
+
+    struct Update
+    {
+        quint64 tabId;
+        Field field;
+        bool flag;
+        QString text;
+        QColor color;
+        Update* next;
+    };
+
+    explicit FancyTabUpdateQueue(FancyTabBar* tabBar)
+        : m_tabBar(tabBar)
+    {
+    }
+    ~FancyTabUpdateQueue();
+
+    FancyTabUpdateQueue(const FancyTabUpdateQueue&)            = delete;
+    FancyTabUpdateQueue& operator=(const FancyTabUpdateQueue&) = delete;
+
+    void setTabEnabled(quint64 tabId, bool enable) { push(new Update { tabId, Enabled, enable, {}, {}, nullptr }); }
+    void setTabVisible(quint64 tabId, bool visible) { push(new Update { tabId, Visible, visible, {}, {}, nullptr }); }
+    void setTabToolTip(quint64 tabId, const QString& toolTip)
+    {
+        push(new Update { tabId, ToolTip, false, toolTip, {}, nullptr });
+    }
+    void setTabText(quint64 tabId, const QString& text)
+    {
+        push(new Update { tabId, Text, false, text, {}, nullptr });
+    }
+    void setTabBadge(quint64 tabId, const QString& badge, const QColor& color = QColor())
+    {
+        push(new Update { tabId, Badge, false, badge, color, nullptr });
+    }
+
+    // Detaches all pending updates, oldest first. The caller owns the nodes.
+    Update* takeAll();
+
+private:
+    void push(Update* update);
+
+    std::atomic<Update*> m_head { nullptr };
+    FancyTabBar* m_tabBar;
 };
 
 class FancyTabBar : public QWidget
 {
     Q_OBJECT
 
+    friend class FancyTab;
+    friend class FancyTabUpdateQueue;
+    template <typename Flow, typename Content, typename Sizing>
+    friend class FancyTabLayoutPolicy;
+
     QPROPERTY_CREATE(QColor, FancyTabBarBackgroundColor, QColor(0x23, 0x23, 0x23))
     QPROPERTY_CREATE(QColor, FancyToolButtonHighlightColor, QColor(0xfb, 0xfd, 0xff, 0xbc))
     QPROPERTY_CREATE(QColor, FancyTabWidgetEnabledSelectedTextColor, QColor(0xfb, 0xfd, 0xff, 0xb6))
@@ -81,16 +350,63 @@ class FancyTabBar : public QWidget
     QPROPERTY_CREATE(QColor, FancyTabBarSelectedBackgroundColor, QColor(0, 0, 0, 0x7a))
     QPROPERTY_CREATE(QColor, FancyToolButtonHoverColor, QColor(0xff, 0xff, 0xff, 0x28))
     QPROPERTY_CREATE(QColor, FancyTabBarIconColor, QColor(0xff, 0xff, 0xff))
+    QPROPERTY_CREATE(QColor, FancyTabBarBadgeColor, QColor(0xe0, 0x4a, 0x3f))
+    QPROPERTY_CREATE(QColor, FancyTabBarBadgeTextColor, QColor(0xff, 0xff, 0xff))
 
 public:
+    // LowBandwidthProfile is meant for remote displays (VNC, X11 forwarding)
+    // where every damaged pixel costs bandwidth: no animations, opaque fills
+    // without antialiasing, and repaints limited to the tabs that changed.
+    enum RenderProfile
+    {
+        DefaultProfile,
+        LowBandwidthProfile
+    };
+    Q_ENUM(RenderProfile)
+
+    // MultiColumnArrangement stacks tabs like VerticalArrangement and
+    // continues in another column when the bar is too short for them.
+    enum Arrangement
+    {
+        VerticalArrangement,
+        HorizontalArrangement,
+        MultiColumnArrangement
+    };
+    Q_ENUM(Arrangement)
+
+    // With MeasuredRowSize each tab takes the space its own label needs
+    // along the bar instead of the space of the longest label.
+    enum RowSizing
+    {
+        FixedRowSize,
+        MeasuredRowSize
+    };
+    Q_ENUM(RowSizing)
+
     FancyTabBar(QWidget* parent = nullptr);
 
+    // Picks LowBandwidthProfile on the vnc platform and for X11 servers
+    // reached over the network, DefaultProfile otherwise.
+    static RenderProfile detectRenderProfile();
+
+    void setRenderProfile(RenderProfile profile);
+
+    RenderProfile renderProfile() const { return m_renderProfile; }
+
+    // Total area of the regions repainted since the last reset, to measure
+    // the damage caused by an interaction, e.g. on the offscreen platform.
+    qint64 damagedPixelCount() const { return m_damagedPixels; }
+
+    void resetDamagedPixelCount() { m_damagedPixels = 0; }
+
     bool event(QEvent* event) override;
 
     void paintEvent(QPaintEvent* event) override;
     void paintTab(QPainter* painter, int tabIndex, int visibleIndex, QIcon::State iconState) const;
     void mousePressEvent(QMouseEvent* event) override;
     void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
     void enterEvent(QEnterEvent* event) override;
     void leaveEvent(QEvent* event) override;
 
@@ -104,50 +420,116 @@ public:
 
     void setTabVisible(int index, bool visible);
 
-    void insertTab(int index, const QIcon& icon, const QString& label, bool hasMenu)
-    {
-        auto tab     = new FancyTab(this);
-        tab->icon    = icon;
-        tab->text    = label;
-        tab->hasMenu = hasMenu;
-        tab->enabled = true;
-        m_tabs.insert(index, tab);
-        if (m_currentIndex >= index)
-        {
-            ++m_currentIndex;
-        }
-        updateGeometry();
-    }
+    void insertTab(int index, const QIcon& icon, const QString& label, bool hasMenu);
 
     void setEnabled(int index, bool enabled);
 
-    void removeTab(int index)
-    {
-        FancyTab* tab = m_tabs.takeAt(index);
-        delete tab;
-        updateGeometry();
-    }
+    void removeTab(int index);
+
+    // Moves the tab at from to position to, keeping its state and the
+    // current selection. Only the rows between from and to are repainted.
+    void moveTab(int from, int to);
+
+    void setTabsMovable(bool movable) { m_movable = movable; }
+
+    bool tabsMovable() const { return m_movable; }
 
     void setCurrentIndex(int index);
 
     int currentIndex() const { return m_currentIndex; }
 
-    void setTabToolTip(int index, const QString& toolTip) { m_tabs[ index ]->toolTip = toolTip; }
+    // Fixed tooltips are only stored for the tabs that have one.
+    void setTabToolTip(int index, const QString& toolTip);
+
+    // Returns the fixed tooltip, else the cached or freshly provided one.
+    // With a provider set, a null string means it answers asynchronously.
+    QString tabToolTip(int index) const;
+
+    // Builds tooltips on demand when a tab without a fixed tooltip is
+    // hovered. Return an empty string for no tooltip, or a null string to
+    // answer later: tabToolTipRequested is then emitted once per tab until
+    // the answer goes to provideTabToolTip, addressed by tabId so that it
+    // reaches the tab even if it moved meanwhile. Results are kept for a few
+    // recently shown tabs until invalidateTabToolTip.
+    using ToolTipProvider = std::function<QString(int index)>;
+    void setTabToolTipProvider(ToolTipProvider provider);
+    void provideTabToolTip(quint64 tabId, const QString& toolTip);
+    void invalidateTabToolTip(int index);
+
+    // Sets the badge shown on the tab. An empty badge with a valid color
+    // draws a status dot; an empty badge without color removes it. May be
+    // called at any rate, repaints are coalesced to the display refresh rate
+    // and limited to the badge area.
+    void setTabBadge(int index, const QString& badge, const QColor& color = QColor());
+
+    QString tabBadge(int index) const { return m_tabs.at(index)->pendingBadge; }
+
+    void setTabText(int index, const QString& text);
+
+    QString tabText(int index) const { return m_tabs.at(index)->text; }
+
+    QIcon tabIcon(int index) const { return m_tabs.at(index)->icon; }
+
+    // Returns the indices of up to limit visible, enabled tabs whose label
+    // fuzzily matches query, best match first.
+    QList<int> findTabs(const QString& query, int limit = 20) const;
 
-    QString tabToolTip(int index) const { return m_tabs.at(index)->toolTip; }
+    // Thread-safe entry point for tab state changes from worker threads.
+    FancyTabUpdateQueue* updateQueue() { return &m_updateQueue; }
+
+    // Handle of the tab that stays valid while tabs are inserted, moved or
+    // removed around it. Ids are never reused.
+    quint64 tabId(int index) const { return m_tabs.at(index)->id; }
+
+    // Current index of the tab, or -1 once it has been removed.
+    int tabIndex(quint64 tabId) const
+    {
+        const FancyTab* tab = m_tabsById.value(tabId);
+        return tab ? tab->index : -1;
+    }
 
     void setIconsOnly(bool iconOnly);
 
+    void setArrangement(Arrangement arrangement);
+
+    Arrangement arrangement() const { return m_arrangement; }
+
+    void setRowSizing(RowSizing sizing);
+
+    RowSizing rowSizing() const { return m_rowSizing; }
+
+    // Name of the layout specialization in use, e.g. to label benchmarks.
+    QString layoutName() const { return QString::fromLatin1(m_layout->name()); }
+
     int count() const { return m_tabs.count(); }
 
+    // Groups are consecutive, non-overlapping tab ranges shown under a
+    // header that collapses them on click. Tabs of a collapsed group are not
+    // laid out, painted or hit-tested. Groups are numbered in display order;
+    // a tab inserted strictly inside a group's range joins that group.
+    int addTabGroup(const QString& name, int first, int count);
+    void removeTabGroup(int group);
+    void setTabGroupCollapsed(int group, bool collapsed);
+    bool isTabGroupCollapsed(int group) const { return m_groups.at(group).collapsed; }
+    int tabGroupCount() const { return m_groups.count(); }
+    QString tabGroupName(int group) const { return m_groups.at(group).name; }
+    int tabGroup(int index) const;
+
+    // Rows are laid out tabs and group headers; a visible index is a row.
     QRect tabRect(int visibleIndex) const;
 
+    // Returns the row of the tab, or -1 when it is hidden or collapsed.
     int visibleIndex(int index) const;
 
 signals:
     void currentAboutToChange(int index);
     void currentChanged(int index);
     void menuTriggered(int index, QMouseEvent* event);
+    void tabMoved(int from, int to);
+    void tabGroupCollapsedChanged(int group, bool collapsed);
+    // The pointer has rested on the tab long enough that a click may follow.
+    void tabHoverSettled(int index);
+    void tabToolTipRequested(int index, quint64 tabId);
 
     // QWidget interface
 
@@ -163,14 +545,78 @@ protected:
                           bool selected) const;
 
 private:
+    using Row = FancyTabRow;
+
+    const QList<Row>& rows() const;
+    void layoutRows() const;
+    void invalidateLayout();
+    void invalidateTabSizeHint();
+    int rowAt(const QPoint& pos) const;
+    int rowKey(const Row& row) const;
+    int headerRow(int group) const;
+    // Under LowBandwidthProfile, composes color over the fill it is drawn on
+    // so that nothing blends; otherwise returns it unchanged.
+    QColor profileColor(const QColor& color, bool selected) const;
+    void revealTab(int index);
+    void updateTabLayout();
+    void updateTab(int index);
+    void renumberTabs(int first, int last);
+    void adjustGroupsForInsert(int index);
+    void adjustGroupsForRemove(int index);
+    void paintTab(QPainter* painter, int tabIndex, const QRect& rect, QIcon::State iconState) const;
+    void updateTabRange(int firstVisibleIndex, int lastVisibleIndex);
+    void dragTabTo(const QPoint& pos);
+    QRect draggedTabRect() const;
+    int tabAt(const QPoint& pos) const;
+    QRect badgeRect(const QRect& rect, const QString& badge, const QColor& color) const;
+    void scheduleFrame();
+    void flushPendingUpdates();
+    void applyQueuedUpdates();
+    void scheduleRenderCacheWarmUp();
+    void warmUpRenderCache();
+
     QRect m_hoverRect;
-    int m_hoverIndex   = -1;
-    int m_currentIndex = -1;
-    bool m_iconsOnly   = false;
+    int m_hoverIndex              = -1;
+    int m_currentIndex            = -1;
+    bool m_iconsOnly              = false;
+    bool m_movable                = false;
+    Arrangement m_arrangement     = VerticalArrangement;
+    RowSizing m_rowSizing         = FixedRowSize;
+    RenderProfile m_renderProfile = DefaultProfile;
+    qint64 m_damagedPixels        = 0;
+    bool m_dragging               = false;
+    int m_pressIndex              = -1;
+    int m_dragPos                 = 0;
+    int m_dragGrabOffset          = 0;
+    QPoint m_pressPos;
+    QTimer m_frameTimer;
+    QTimer m_hoverSettleTimer;
+    QTimer m_warmUpTimer;
+    int m_warmUpIndex = 0;
+    QList<FancyTab*> m_pendingBadges;
+    FancyTabIndex m_labelIndex;
+    QHash<const FancyTab*, QString> m_toolTips;
+    mutable QCache<const FancyTab*, QString> m_toolTipCache { 16 };
+    QSet<const FancyTab*> m_pendingToolTips;
+    ToolTipProvider m_toolTipProvider;
+    FancyTabUpdateQueue m_updateQueue { this };
+    std::shared_ptr<FancyRenderCache> m_renderCache = FancyRenderCache::instance();
+    std::unique_ptr<FancyTabLayout> m_layout;
     QList<FancyTab*> m_tabs;
+    QHash<quint64, FancyTab*> m_tabsById;
+    quint64 m_nextTabId = 1;
+    QList<FancyTabGroup> m_groups;
+    mutable QList<Row> m_rows;
+    mutable bool m_rowsValid         = false;
+    mutable int m_layoutTabRows      = 0;
+    mutable int m_layoutHeaderRows   = 0;
+    mutable bool m_tabSizeHintsValid = false;
+    mutable QSize m_tabSizeHints[ 2 ];
     QSize tabSizeHint(bool minimum = false) const;
 };
 
+class FancyTabQuickSwitcher;
+
 #if 1
 class FancyTabWidget : public QWidget
 {
@@ -181,8 +627,17 @@ public:
 
     void insertTab(int index, QWidget *tab, const QIcon &icon, const QString &label, bool hasMenu);
     void removeTab(int index);
+    void moveTab(int from, int to);
+    void setTabsMovable(bool movable);
     void setBackgroundBrush(const QBrush &brush);
     void setTabToolTip(int index, const QString &toolTip);
+    void setTabToolTipProvider(FancyTabBar::ToolTipProvider provider);
+    void provideTabToolTip(quint64 tabId, const QString &toolTip);
+    void invalidateTabToolTip(int index);
+    void setTabBadge(int index, const QString &badge, const QColor &color = QColor());
+    void setTabText(int index, const QString &text);
+    FancyTabUpdateQueue *updateQueue() const;
+    quint64 tabId(int index) const;
 
     int currentIndex() const;
 
@@ -191,19 +646,53 @@ public:
     void setTabVisible(int index, bool visible);
 
     void setIconsOnly(bool iconsOnly);
+    void setRenderProfile(FancyTabBar::RenderProfile profile);
+
+    // Puts the bar above the pages for HorizontalArrangement, beside them
+    // otherwise.
+    void setTabBarArrangement(FancyTabBar::Arrangement arrangement);
+    void setTabRowSizing(FancyTabBar::RowSizing sizing);
+
+    // With prepared switching, a page that was never shown is polished,
+    // resized and laid out off screen in one event loop pass after the click
+    // and swapped in and first painted in the next, so neither step runs
+    // inside the click or together with the other. Resting the pointer on a
+    // tab prepares its page ahead of time and renders a frame of it, which is
+    // shown as a placeholder until the swap.
+    void setPreparedSwitchEnabled(bool enabled);
+
+    int addTabGroup(const QString &name, int first, int count);
+    void setTabGroupCollapsed(int group, bool collapsed);
 
 signals:
     void currentAboutToShow(int index);
     void currentChanged(int index);
     void menuTriggered(int index, QMouseEvent *event);
+    void tabToolTipRequested(int index, quint64 tabId);
 
 public slots:
     void setCurrentIndex(int index);
+    void showQuickSwitcher();
 
 private:
     void showWidget(int index);
+    void activatePage(int index);
+    void preparePage(QWidget *page);
+    void prepareHoveredPage(int index);
+    void showPlaceholder(const QPixmap &frame);
+    void finishPendingSwitch();
 
     FancyTabBar *m_tabBar;
     QStackedLayout *m_modesStack;
+    // Pages in tab order; the stack itself keeps insertion order so that
+    // reordering tabs never touches the stacked layout.
+    QList<QWidget *> m_pages;
+    FancyTabQuickSwitcher *m_quickSwitcher = nullptr;
+    bool m_preparedSwitch                  = false;
+    QPointer<QWidget> m_pendingPage;
+    QLabel *m_placeholder = nullptr;
+    QSet<QWidget *> m_preparedPages;
+    // Frames of hovered pages, least recently hovered dropped first.
+    QCache<QWidget *, QPixmap> m_pageFrames { 32 * 1024 * 1024 };
 };
 #endif